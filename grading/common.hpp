@@ -24,17 +24,34 @@
 #pragma once
 
 // External headers
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
 #include <exception>
+#include <fstream>
 #include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
 #include <thread>
+#include <tuple>
 #include <utility>
+#include <vector>
 extern "C" {
+#include <linux/perf_event.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
 #include <time.h>
+#include <unistd.h>
 }
 
 // -------------------------------------------------------------------------- //
@@ -115,6 +132,9 @@ public:
 EXCEPTION(Unreachable, Any, "unreachable code reached");
 EXCEPTION(Bounded, Any, "bounded execution exception");
     EXCEPTION(BoundedOverrun, Any, "bounded execution overrun");
+EXCEPTION(Affinity, Any, "thread placement exception");
+    EXCEPTION(AffinityPolicy, Affinity, "unknown placement policy or invalid CPU list");
+    EXCEPTION(AffinitySet, Affinity, "unable to set the CPU affinity of a worker thread");
 
 }
 // -------------------------------------------------------------------------- //
@@ -148,7 +168,7 @@ public:
     /** Tick constructor.
      * @param tick Initial number of ticks (optional)
     **/
-    Chrono(Tick tick = 0) noexcept: total{tick} {}
+    Chrono(Tick tick = 0) noexcept: total{tick}, local{0} {}
 private:
     /** Call a "clock" function, convert the result to the Tick type.
      * @param func "Clock" function to call
@@ -199,6 +219,100 @@ public:
     }
 };
 
+/** Log-linear histogram class (HDR-style), with a bounded relative error on the recorded values.
+**/
+class Histogram final {
+public:
+    /** Value class.
+    **/
+    using Value = uint_fast64_t;
+private:
+    constexpr static auto sub_bits  = 6u;                        // Number of significant bits kept per value
+    constexpr static auto sub_count = Value{1} << sub_bits;      // Number of exact buckets (values below)
+    constexpr static auto half      = sub_count / 2;             // Number of buckets per power of 2 above
+    constexpr static auto nbbuckets = sub_count + (64 - sub_bits) * half;
+private:
+    ::std::array<uint_fast64_t, nbbuckets> buckets; // Number of values recorded per bucket
+    uint_fast64_t count; // Number of recorded values
+    Value         max;   // Maximum recorded value
+private:
+    /** Get the bucket of a value.
+     * @param value Value to classify
+     * @return Bucket index
+    **/
+    constexpr static size_t index_of(Value value) noexcept {
+        if (value < sub_count)
+            return value;
+        auto shift = (63u - static_cast<unsigned int>(__builtin_clzll(value))) - (sub_bits - 1);
+        return sub_count + (shift - 1) * half + ((value >> shift) - half);
+    }
+    /** Get the highest value falling in a bucket.
+     * @param index Bucket index
+     * @return Highest equivalent value
+    **/
+    constexpr static Value highest_of(size_t index) noexcept {
+        if (index < sub_count)
+            return index;
+        auto shift = (index - sub_count) / half + 1;
+        auto mantissa = (index - sub_count) % half + half;
+        return ((mantissa + 1) << shift) - 1;
+    }
+public:
+    /** Empty constructor.
+    **/
+    Histogram() noexcept: buckets{}, count{0}, max{0} {}
+public:
+    /** Record one value.
+     * @param value Value to record
+    **/
+    void record(Value value) noexcept {
+        ++buckets[index_of(value)];
+        ++count;
+        if (value > max)
+            max = value;
+    }
+    /** Add all the values recorded in another histogram.
+     * @param other Histogram to merge
+    **/
+    void merge(Histogram const& other) noexcept {
+        for (size_t i = 0; i < nbbuckets; ++i)
+            buckets[i] += other.buckets[i];
+        count += other.count;
+        if (other.max > max)
+            max = other.max;
+    }
+    /** Get the number of recorded values.
+     * @return Number of recorded values
+    **/
+    auto get_count() const noexcept {
+        return count;
+    }
+    /** Get the maximum recorded value.
+     * @return Maximum recorded value, 0 if none
+    **/
+    auto get_max() const noexcept {
+        return max;
+    }
+    /** Get the value at the given percentile.
+     * @param percent Percentile, in [0, 100]
+     * @return Highest value equivalent to the one at the percentile, 0 if none recorded
+    **/
+    Value percentile(double percent) const noexcept {
+        auto rank = static_cast<uint_fast64_t>(percent / 100. * static_cast<double>(count) + 0.5);
+        if (rank == 0)
+            rank = 1;
+        uint_fast64_t seen = 0;
+        for (size_t i = 0; i < nbbuckets; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                auto res = highest_of(i);
+                return res < max ? res : max;
+            }
+        }
+        return max;
+    }
+};
+
 /** Atomic waitable latch class.
 **/
 class Latch final {
@@ -331,3 +445,342 @@ public:
         }
     }
 };
+
+// -------------------------------------------------------------------------- //
+
+/** CPU topology class, restricted to the CPUs the process may run on.
+**/
+class Topology final {
+public:
+    /** Logical CPU class.
+    **/
+    struct Cpu {
+        int id;      // Logical CPU number
+        int package; // Physical package (socket) number
+        int core;    // Core number in the package
+    };
+private:
+    ::std::vector<Cpu> cpus; // Usable logical CPUs, by increasing number
+private:
+    /** Read one topology attribute of a logical CPU from sysfs.
+     * @param cpu  Logical CPU number
+     * @param name Attribute name
+     * @param def  Value to return if the attribute is unavailable
+     * @return Attribute value
+    **/
+    static int read_attr(int cpu, char const* name, int def) {
+        ::std::ifstream file{"/sys/devices/system/cpu/cpu" + ::std::to_string(cpu) + "/topology/" + name};
+        int res;
+        if (!(file >> res))
+            return def;
+        return res;
+    }
+public:
+    /** Discovery constructor.
+    **/
+    Topology() {
+        ::cpu_set_t set;
+        CPU_ZERO(&set);
+        if (unlikely(::sched_getaffinity(0, sizeof(set), &set) != 0)) { // Assume the CPUs are the first ones
+            for (unsigned int i = 0; i < ::std::thread::hardware_concurrency(); ++i)
+                CPU_SET(i, &set);
+        }
+        for (int i = 0; i < CPU_SETSIZE; ++i) {
+            if (CPU_ISSET(i, &set))
+                cpus.push_back(Cpu{i, read_attr(i, "physical_package_id", 0), read_attr(i, "core_id", i)});
+        }
+    }
+public:
+    /** Get the usable logical CPUs.
+     * @return Usable logical CPUs, by increasing number
+    **/
+    auto const& get_cpus() const noexcept {
+        return cpus;
+    }
+    /** Count the physical packages.
+     * @return Number of distinct packages
+    **/
+    size_t count_packages() const {
+        ::std::vector<int> packages;
+        for (auto&& cpu: cpus)
+            packages.push_back(cpu.package);
+        ::std::sort(packages.begin(), packages.end());
+        return ::std::unique(packages.begin(), packages.end()) - packages.begin();
+    }
+    /** Count the physical cores.
+     * @return Number of distinct cores
+    **/
+    size_t count_cores() const {
+        ::std::vector<::std::pair<int, int>> cores;
+        for (auto&& cpu: cpus)
+            cores.emplace_back(cpu.package, cpu.core);
+        ::std::sort(cores.begin(), cores.end());
+        return ::std::unique(cores.begin(), cores.end()) - cores.begin();
+    }
+    /** Order the logical CPUs following a placement policy, the i-th worker thread being placed on the i-th CPU (modulo).
+     * @param policy 'compact' (fill the SMT siblings, then the cores of a package, then the next package),
+     *               'scatter' (alternate between the packages, then between the cores, using SMT siblings last),
+     *               'cores' (one CPU per physical core, packages filled in turn),
+     *               or an explicit comma-separated list of CPU numbers and ranges (e.g. '0,2,4-7')
+     * @return Ordered logical CPU numbers
+    **/
+    ::std::vector<int> order(::std::string const& policy) const {
+        ::std::vector<int> res;
+        auto sorted = cpus;
+        auto smt_rank = [&](Cpu const& cpu) { // Rank of the CPU among its SMT siblings
+            auto rank = 0;
+            for (auto&& other: cpus) {
+                if (other.package == cpu.package && other.core == cpu.core && other.id < cpu.id)
+                    ++rank;
+            }
+            return rank;
+        };
+        if (policy == "compact") {
+            ::std::stable_sort(sorted.begin(), sorted.end(), [](Cpu const& a, Cpu const& b) {
+                return ::std::make_pair(a.package, a.core) < ::std::make_pair(b.package, b.core);
+            });
+        } else if (policy == "scatter" || policy == "cores") {
+            ::std::vector<::std::pair<int, int>> ranks; // SMT rank, then rank of the core in its package
+            for (auto&& cpu: cpus) {
+                auto core_rank = 0;
+                for (auto&& other: cpus) {
+                    if (other.package == cpu.package && other.core < cpu.core && smt_rank(other) == 0)
+                        ++core_rank;
+                }
+                ranks.emplace_back(smt_rank(cpu), core_rank);
+            }
+            ::std::vector<size_t> indices(cpus.size());
+            for (size_t i = 0; i < indices.size(); ++i)
+                indices[i] = i;
+            ::std::stable_sort(indices.begin(), indices.end(), [&](size_t a, size_t b) {
+                if (policy == "cores") // Packages filled in turn
+                    return ::std::make_tuple(ranks[a].first, cpus[a].package, ranks[a].second) < ::std::make_tuple(ranks[b].first, cpus[b].package, ranks[b].second);
+                return ::std::make_tuple(ranks[a].first, ranks[a].second, cpus[a].package) < ::std::make_tuple(ranks[b].first, ranks[b].second, cpus[b].package);
+            });
+            sorted.clear();
+            for (auto i: indices) {
+                if (policy == "scatter" || ranks[i].first == 0)
+                    sorted.push_back(cpus[i]);
+            }
+        } else { // Explicit list
+            size_t pos = 0;
+            while (pos < policy.size()) {
+                size_t end;
+                int first, last;
+                try {
+                    first = ::std::stoi(policy.substr(pos), &end);
+                    pos += end;
+                    last = first;
+                    if (pos < policy.size() && policy[pos] == '-') {
+                        last = ::std::stoi(policy.substr(pos + 1), &end);
+                        pos += end + 1;
+                    }
+                } catch (::std::logic_error const&) {
+                    throw Exception::AffinityPolicy{};
+                }
+                if (unlikely(first < 0 || last < first || last >= CPU_SETSIZE || (pos < policy.size() && policy[pos++] != ',')))
+                    throw Exception::AffinityPolicy{};
+                for (auto cpu = first; cpu <= last; ++cpu)
+                    res.push_back(cpu);
+            }
+            if (unlikely(res.empty()))
+                throw Exception::AffinityPolicy{};
+            return res;
+        }
+        for (auto&& cpu: sorted)
+            res.push_back(cpu.id);
+        return res;
+    }
+    /** Pin a thread on one logical CPU.
+     * @param thread Thread to pin
+     * @param cpu    Logical CPU number
+    **/
+    static void pin(::std::thread& thread, int cpu) {
+        ::cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (unlikely(::pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) != 0))
+            throw Exception::AffinitySet{};
+    }
+};
+
+/** Hardware performance counters of the calling thread class, each counter silently unavailable if the kernel denies it.
+**/
+class PerfCounters final: private NonCopyable {
+public:
+    /** Counted events.
+    **/
+    enum Event: size_t {
+        cycles,
+        instructions,
+        llc_misses,
+        branch_misses,
+        context_switches,
+        nbevents // Number of events
+    };
+    /** Accumulated counts class, an event being empty if unavailable in at least one thread.
+    **/
+    class Counts final {
+    private:
+        ::std::array<::std::optional<uint_fast64_t>, nbevents> values; // Count of each event
+        bool empty; // Whether nothing was accumulated yet
+    public:
+        /** Empty constructor.
+        **/
+        Counts() noexcept: values{}, empty{true} {}
+    public:
+        /** Get the accumulated count of an event.
+         * @param event Event to query
+         * @return Accumulated count, empty if unavailable
+        **/
+        auto const& get(Event event) const noexcept {
+            return values[event];
+        }
+        /** Add other counts.
+         * @param other Counts to add
+        **/
+        void merge(Counts const& other) noexcept {
+            if (other.empty)
+                return;
+            for (size_t i = 0; i < nbevents; ++i) {
+                if (empty) {
+                    values[i] = other.values[i];
+                } else if (values[i] && other.values[i]) {
+                    *values[i] += *other.values[i];
+                } else {
+                    values[i].reset();
+                }
+            }
+            empty = false;
+        }
+        /** Add the counts of one measured section.
+         * @param counts Count of each event, empty if unavailable
+        **/
+        void merge(::std::array<::std::optional<uint_fast64_t>, nbevents> const& counts) noexcept {
+            Counts other;
+            other.values = counts;
+            other.empty = false;
+            merge(other);
+        }
+    };
+private:
+    int fds[nbevents]; // File descriptor of each counter, -1 if unavailable
+public:
+    /** Get the name of an event.
+     * @param event Event to name
+     * @return Constant null-terminated name
+    **/
+    static char const* name(size_t event) noexcept {
+        char const* names[] = {"cycles", "instructions", "llc_misses", "branch_misses", "context_switches"};
+        return names[event];
+    }
+public:
+    /** Open the (disabled) counters of the calling thread.
+    **/
+    PerfCounters() noexcept {
+        struct {
+            uint32_t type;
+            uint64_t config;
+        } const events[] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES}
+        };
+        for (size_t i = 0; i < nbevents; ++i) {
+            struct ::perf_event_attr attr;
+            ::std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[i].type;
+            attr.config = events[i].config;
+            attr.disabled = 1;
+            attr.exclude_kernel = (events[i].type == PERF_TYPE_HARDWARE ? 1 : 0); // Often required by 'perf_event_paranoid'
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING; // To scale multiplexed counts
+            fds[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+    }
+    /** Close the counters.
+    **/
+    ~PerfCounters() noexcept {
+        for (auto fd: fds) {
+            if (fd >= 0)
+                ::close(fd);
+        }
+    }
+public:
+    /** Reset and start counting.
+    **/
+    void start() noexcept {
+        for (auto fd: fds) {
+            if (fd >= 0) {
+                ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+    /** Stop counting, and accumulate the counts since the last start.
+     * @param counts Counts to accumulate into
+    **/
+    void stop(Counts& counts) noexcept {
+        ::std::array<::std::optional<uint_fast64_t>, nbevents> res;
+        for (size_t i = 0; i < nbevents; ++i) {
+            if (fds[i] < 0)
+                continue;
+            ::ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t buf[3]; // Value, time enabled, time running
+            if (unlikely(::read(fds[i], buf, sizeof(buf)) != sizeof(buf)))
+                continue;
+            if (buf[2] == 0) { // Never running, nothing to scale
+                res[i] = buf[0];
+            } else {
+                res[i] = static_cast<uint_fast64_t>(static_cast<double>(buf[0]) * static_cast<double>(buf[1]) / static_cast<double>(buf[2]));
+            }
+        }
+        counts.merge(res);
+    }
+};
+
+/** Process-wide memory usage at one point in time class, each quantity silently unavailable if the system does not provide it.
+**/
+struct MemoryUsage {
+    ::std::optional<uint_fast64_t> peak_rss; // Peak resident set size since the last 'reset_peak' (in bytes)
+    ::std::optional<uint_fast64_t> rss;      // Resident set size (in bytes)
+    uint_fast64_t minor_faults; // Number of minor page faults since the process started
+    uint_fast64_t major_faults; // Number of major page faults since the process started
+    uint_fast64_t heap;         // Bytes in use in the memory allocator, every arena and mapping included
+    /** Reset the peak resident set size to the current one (Linux only).
+     * @return Whether the peak was reset
+    **/
+    static bool reset_peak() noexcept {
+        ::std::ofstream file{"/proc/self/clear_refs"};
+        file << "5";
+        file.flush();
+        return file.good();
+    }
+    /** Take a snapshot of the memory usage of the process.
+     * @return Memory usage
+    **/
+    static MemoryUsage take() noexcept {
+        MemoryUsage res{{}, {}, 0, 0, 0};
+        { // Resident set sizes, as the peak of 'getrusage' cannot be reset
+            ::std::ifstream file{"/proc/self/status"};
+            for (::std::string line; ::std::getline(file, line);) {
+                auto kb = [&]() { return static_cast<uint_fast64_t>(::std::strtoull(line.c_str() + line.find(':') + 1, nullptr, 10)) * 1024; };
+                if (line.compare(0, 6, "VmHWM:") == 0)
+                    res.peak_rss = kb();
+                if (line.compare(0, 6, "VmRSS:") == 0)
+                    res.rss = kb();
+            }
+        }
+        struct ::rusage usage;
+        if (likely(::getrusage(RUSAGE_SELF, &usage) == 0)) {
+            res.minor_faults = static_cast<uint_fast64_t>(usage.ru_minflt);
+            res.major_faults = static_cast<uint_fast64_t>(usage.ru_majflt);
+        }
+        auto info = ::mallinfo2();
+        res.heap = info.uordblks + info.hblkhd;
+        return res;
+    }
+};
@@ -24,10 +24,15 @@
 // External headers
 #include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <random>
+#include <sstream>
 #include <variant>
+#include <vector>
 
 // Internal headers
 #include "common.hpp"
@@ -138,43 +143,203 @@ public:
     }
 };
 
-/** Measure the arithmetic mean of the execution time of the given workload with the given transaction library.
+/** Throughput timeline of the repetitions class, sampled by a dedicated thread.
+**/
+class Timeline final: private NonCopyable {
+public:
+    /** Commit counter of one worker class, alone in its cache line.
+    **/
+    struct alignas(64) Counter {
+        ::std::atomic<uint_fast64_t> commits{0}; // Number of committed transactions
+    };
+    /** Sample class.
+    **/
+    struct Sample {
+        Chrono::Tick  tick;    // End of the interval, since the first repetition started (in ns)
+        uint_fast64_t commits; // Number of transactions committed during the interval
+    };
+private:
+    Chrono::Tick interval; // Sampling interval (in ns)
+    ::std::vector<Counter> counters; // Counter of each worker
+    Chrono clock; // Started with the first repetition
+    ::std::atomic<bool> done; // Whether the sampler must stop
+    ::std::thread sampler; // Sampling thread, started with the first repetition
+    uint_fast64_t last; // Sum of the counters at the last sample
+    ::std::vector<Sample> samples; // Samples taken so far
+    ::std::vector<Chrono::Tick> starts; // Start of each repetition, since the first one started (in ns)
+public:
+    /** Workers constructor.
+     * @param nbworkers Number of workers
+     * @param interval  Sampling interval (in ns)
+    **/
+    Timeline(size_t nbworkers, Chrono::Tick interval): interval{interval}, counters(nbworkers), done{false}, last{0} {}
+    /** Stopping destructor.
+    **/
+    ~Timeline() {
+        finish();
+    }
+private:
+    /** Take one sample.
+    **/
+    void sample() {
+        uint_fast64_t sum = 0;
+        for (auto&& counter: counters)
+            sum += counter.commits.load(::std::memory_order_relaxed);
+        samples.push_back(Sample{clock.delta(), sum - last});
+        last = sum;
+    }
+public:
+    /** [thread-safe] Get the commit counter of one worker.
+     * @param i Index of the worker
+     * @return Counter only written by the given worker
+    **/
+    auto& get(size_t i) noexcept {
+        return counters[i].commits;
+    }
+    /** Mark the start of a repetition, starting the sampler with the first one.
+    **/
+    void mark() {
+        auto first = !sampler.joinable();
+        if (first)
+            clock.start();
+        starts.push_back(clock.delta());
+        if (first) {
+            sampler = ::std::thread{[&]() {
+                for (auto next = interval; !done.load(::std::memory_order_relaxed); next += interval) {
+                    auto now = clock.delta();
+                    if (now < next)
+                        ::std::this_thread::sleep_for(::std::chrono::nanoseconds{next - now});
+                    sample();
+                }
+            }};
+        }
+    }
+    /** Stop the sampler, if started, and take the last (partial) sample.
+    **/
+    void finish() {
+        if (!sampler.joinable())
+            return;
+        done.store(true, ::std::memory_order_relaxed);
+        sampler.join();
+        sample();
+    }
+    /** Get the samples, once finished.
+     * @return Samples in order
+    **/
+    auto const& get_samples() const noexcept {
+        return samples;
+    }
+    /** Get the start of each repetition.
+     * @return Start of each repetition, since the first one started (in ns)
+    **/
+    auto const& get_starts() const noexcept {
+        return starts;
+    }
+};
+
+/** Measurement result class.
+**/
+struct Measurement {
+    char const*  error;     // Error constant null-terminated string ('nullptr' for none)
+    Chrono::Tick tick_init; // Duration of the initialization (in ns)
+    ::std::vector<Chrono::Tick> ticks; // Duration of each measured repetition, in order, warmups and recorded repetition excluded (in ns)
+    Chrono::Tick tick_chck; // Duration of the correctness check (in ns)
+    Aborts       aborts;    // Abort accounting of the measured repetitions
+    PerfCounters::Counts counters; // Hardware performance counters of the measured repetitions, summed over the threads
+    Histogram    latency;   // Open-loop latency of the measured repetitions, from the intended start of each transaction (in ns)
+    ::std::vector<Timeline::Sample> timeline; // Throughput timeline of every repetition, warmups included
+    ::std::vector<Chrono::Tick> starts; // Start of each repetition in the timeline (in ns)
+};
+
+/** Measure the execution time of each repetition of the given workload with the given transaction library.
  * @param workload     Workload instance to use
  * @param nbthreads    Number of concurrent threads to use
- * @param nbrepeats    Number of repetitions (keep the median)
+ * @param nbwarmups    Number of discarded warmup repetitions
+ * @param nbrepeats    Number of measured repetitions
  * @param seed         Seed to use for performance measurements
  * @param maxtick_init Timeout for (re)initialization ('Chrono::invalid_tick' for none)
- * @param maxtick_perf Timeout for performance measurements ('Chrono::invalid_tick' for none)
+ * @param maxtick_perf Timeout for each repetition ('Chrono::invalid_tick' for none)
  * @param maxtick_chck Timeout for correctness check ('Chrono::invalid_tick' for none)
- * @return Error constant null-terminated string ('nullptr' for none), execution times (in ns) (undefined if inconsistency detected)
+ * @param cpus         Logical CPU of each worker thread, modulo its size (empty for no placement)
+ * @param counters     Whether to count hardware performance events during the measured repetitions
+ * @param trace        Recording of one extra, unmeasured repetition run just before the measured ones ('nullptr' for none)
+ * @param rate         Open-loop arrival rate of each thread (in TX/s), 0 for closed loop
+ * @param interval     Sampling interval of the throughput timeline (in ns), 0 for none
+ * @param ledger       Live shared memory accounting of every phase ('nullptr' for none)
+ * @return Measurement, with durations undefined if an inconsistency was detected
 **/
-static auto measure(Workload& workload, unsigned int const nbthreads, unsigned int const nbrepeats, Seed seed, Chrono::Tick maxtick_init, Chrono::Tick maxtick_perf, Chrono::Tick maxtick_chck) {
+static auto measure(Workload& workload, unsigned int const nbthreads, unsigned int const nbwarmups, unsigned int const nbrepeats, Seed seed, Chrono::Tick maxtick_init, Chrono::Tick maxtick_perf, Chrono::Tick maxtick_chck, ::std::vector<int> const& cpus, bool counters, TraceRecording* trace, double rate, Chrono::Tick interval, SharedLedger* ledger) {
     ::std::vector<::std::thread> threads(nbthreads);
     ::std::mutex  cerrlock;        // To avoid interleaving writes to 'cerr' in case more than one thread throw
+    ::std::vector<Aborts> aborts(nbthreads); // Abort accounting of each thread, during the measured repetitions
+    ::std::vector<PerfCounters::Counts> counts(nbthreads); // Hardware performance counters of each thread, during the measured repetitions
+    ::std::vector<Histogram> latencies(nbthreads); // Open-loop latency of each thread, during the measured repetitions
+    ::std::optional<Timeline> timeline; // Throughput timeline of every repetition
+    if (interval > 0)
+        timeline.emplace(nbthreads, interval);
     Sync          sync{nbthreads}; // "As-synchronized-as-possible" starts so that threads interfere "as-much-as-possible"
+    auto const nbtraced = trace ? 1u : 0u; // Number of recorded repetitions, run after the warmups and left out of every statistic
+    auto const nbskipped = nbwarmups + nbtraced; // Number of repetitions preceding the measured ones
     for (unsigned int i = 0; i < nbthreads; ++i) { // Start threads
         try {
             threads[i] = ::std::thread{[&](unsigned int i) {
                 try {
+                    ::std::optional<PerfCounters> perf;
+                    if (counters)
+                        perf.emplace();
+                    ::std::optional<Arrivals> arrivals;
+                    if (rate > 0.)
+                        arrivals.emplace(rate);
+                    transactional_ledger = ledger;
                     // Initialization
                     if (!sync.worker_wait())
                         return;
                     sync.worker_notify(workload.init());
                     // Performance measurements
-                    for (unsigned int count = 0; count < nbrepeats; ++count) {
+                    for (unsigned int count = 0; count < nbskipped + nbrepeats; ++count) {
                         if (!sync.worker_wait())
                             return;
-                        sync.worker_notify(workload.run(i, seed + nbthreads * count + i));
+                        if (count == nbskipped) { // First measured repetition
+                            workload.reset_stats(i);
+                            transactional_aborts = &aborts[i];
+                        }
+                        transactional_trace = trace && count == nbwarmups ? &trace->get(i) : nullptr;
+                        transactional_commits = timeline ? &timeline->get(i) : nullptr;
+                        auto const repseed = seed + nbthreads * (count > nbwarmups ? count - nbtraced : count) + i; // The recorded repetition shares the seed of the first measured one
+                        if (arrivals) { // Every repetition follows its own schedule, started when the workers are released
+                            if (count == nbskipped)
+                                arrivals->reset();
+                            arrivals->restart(repseed);
+                            transactional_arrivals = &*arrivals;
+                        }
+                        if (perf && count >= nbskipped)
+                            perf->start();
+                        auto error = workload.run(i, repseed);
+                        if (perf && count >= nbskipped)
+                            perf->stop(counts[i]);
+                        sync.worker_notify(error);
                     }
+                    transactional_aborts = nullptr;
+                    transactional_trace = nullptr;
+                    transactional_arrivals = nullptr;
+                    transactional_commits = nullptr;
+                    if (arrivals)
+                        latencies[i] = arrivals->get_latency();
                     // Correctness check
                     if (!sync.worker_wait())
                         return;
                     sync.worker_notify(workload.check(i, std::random_device{}())); // Random seed is wanted here
+                    transactional_ledger = nullptr;
                     // Synchronized quit
                     if (!sync.worker_wait())
                         return;
                     throw Exception::Unreachable{"unexpected worker iteration after checks"};
                 } catch (::std::exception const& err) {
+                    transactional_aborts = nullptr;
+                    transactional_trace = nullptr;
+                    transactional_arrivals = nullptr;
+                    transactional_commits = nullptr;
+                    transactional_ledger = nullptr;
                     sync.worker_notify("Internal worker exception(s)"); // Exception post-'Sync::worker_wait' (i.e. in 'Workload::run' or 'Workload::check'), since 'Sync::worker_*' do not throw
                     { // Print the error
                         ::std::unique_lock<decltype(cerrlock)> guard{cerrlock};
@@ -183,54 +348,71 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
                     return;
                 }
             }, i};
+            if (!cpus.empty())
+                Topology::pin(threads[i], cpus[i % cpus.size()]);
         } catch (...) {
-            for (unsigned int j = 0; j < i; ++j) // Detach threads to avoid termination due to attached thread going out of scope
-                threads[j].detach();
+            for (unsigned int j = 0; j <= i; ++j) { // Detach threads to avoid termination due to attached thread going out of scope
+                if (threads[j].joinable())
+                    threads[j].detach();
+            }
             throw;
         }
     }
     try {
-        char const* error = nullptr;
-        Chrono::Tick time_init = Chrono::invalid_tick;
-        Chrono::Tick times[nbrepeats];
-        Chrono::Tick time_chck = Chrono::invalid_tick;
-        auto const posmedian = nbrepeats / 2;
+        Measurement res{nullptr, Chrono::invalid_tick, {}, Chrono::invalid_tick, {}, {}, {}, {}, {}};
+        Chrono::Tick last = 0; // The runtime accumulates over the phases
         { // Initialization (with cheap correctness test)
             sync.master_notify();
-            auto res = sync.master_wait(maxtick_init);
-            if (unlikely(::std::holds_alternative<char const*>(res))) {
-                error = ::std::get<char const*>(res);
+            auto time = sync.master_wait(maxtick_init);
+            if (unlikely(::std::holds_alternative<char const*>(time))) {
+                res.error = ::std::get<char const*>(time);
                 goto join;
             }
-            time_init = ::std::get<Chrono>(res).get_tick();
+            last = res.tick_init = ::std::get<Chrono>(time).get_tick();
         }
         { // Performance measurements (with cheap correctness tests)
-            for (unsigned int i = 0; i < nbrepeats; ++i) {
+            for (unsigned int i = 0; i < nbskipped + nbrepeats; ++i) {
+                if (timeline)
+                    timeline->mark();
                 sync.master_notify();
-                auto res = sync.master_wait(maxtick_perf);
-                if (unlikely(::std::holds_alternative<char const*>(res))) {
-                    error = ::std::get<char const*>(res);
+                auto time = sync.master_wait(maxtick_perf);
+                if (unlikely(::std::holds_alternative<char const*>(time))) {
+                    res.error = ::std::get<char const*>(time);
                     goto join;
                 }
-                times[i] = ::std::get<Chrono>(res).get_tick();
+                auto tick = ::std::get<Chrono>(time).get_tick();
+                if (i >= nbskipped)
+                    res.ticks.push_back(tick - last);
+                last = tick;
             }
-            ::std::nth_element(times, times + posmedian, times + nbrepeats); // Partition times around the median
+            if (timeline)
+                timeline->finish();
         }
         { // Correctness check
             sync.master_notify();
-            auto res = sync.master_wait(maxtick_chck);
-            if (unlikely(::std::holds_alternative<char const*>(res))) {
-                error = ::std::get<char const*>(res);
+            auto time = sync.master_wait(maxtick_chck);
+            if (unlikely(::std::holds_alternative<char const*>(time))) {
+                res.error = ::std::get<char const*>(time);
                 goto join;
             }
-            time_chck = ::std::get<Chrono>(res).get_tick();
+            res.tick_chck = ::std::get<Chrono>(time).get_tick() - last;
         }
         join: { // Joining
             sync.master_join(); // Join with threads
             for (unsigned int i = 0; i < nbthreads; ++i)
                 threads[i].join();
         }
-        return ::std::make_tuple(error, time_init, times[posmedian], time_chck);
+        if (timeline) {
+            timeline->finish();
+            res.timeline = timeline->get_samples();
+            res.starts = timeline->get_starts();
+        }
+        for (unsigned int i = 0; i < nbthreads; ++i) {
+            res.aborts.merge(aborts[i]);
+            res.counters.merge(counts[i]);
+            res.latency.merge(latencies[i]);
+        }
+        return res;
     } catch (...) {
         for (unsigned int i = 0; i < nbthreads; ++i) // Detach threads to avoid termination due to attached thread going out of scope
             threads[i].detach();
@@ -238,6 +420,562 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
     }
 }
 
+/** Summary statistics of repetition durations class.
+**/
+struct Summary {
+    double median;  // Median (in ns)
+    double trimmed; // Mean of the repetitions left after discarding the fastest and slowest 20% (in ns)
+    double stddev;  // Sample standard deviation (in ns)
+};
+
+/** Get the median of some durations.
+ * @param ticks Non-empty durations (reordered)
+ * @return Median (in ns)
+**/
+static double median(::std::vector<Chrono::Tick>& ticks) {
+    auto const pos = ticks.size() / 2;
+    ::std::nth_element(ticks.begin(), ticks.begin() + pos, ticks.end());
+    auto res = static_cast<double>(ticks[pos]);
+    if (ticks.size() % 2 == 0) // Average with the highest of the lower half
+        res = (res + static_cast<double>(*::std::max_element(ticks.begin(), ticks.begin() + pos))) / 2.;
+    return res;
+}
+
+/** Summarize some durations.
+ * @param ticks Non-empty durations
+ * @return Summary statistics
+**/
+static Summary summarize(::std::vector<Chrono::Tick> ticks) {
+    Summary res;
+    res.median = median(ticks);
+    ::std::sort(ticks.begin(), ticks.end());
+    auto const trim = ticks.size() / 5;
+    auto sum = 0.;
+    for (auto i = trim; i < ticks.size() - trim; ++i)
+        sum += static_cast<double>(ticks[i]);
+    res.trimmed = sum / static_cast<double>(ticks.size() - 2 * trim);
+    auto mean = 0.;
+    for (auto tick: ticks)
+        mean += static_cast<double>(tick);
+    mean /= static_cast<double>(ticks.size());
+    auto var = 0.;
+    for (auto tick: ticks)
+        var += (static_cast<double>(tick) - mean) * (static_cast<double>(tick) - mean);
+    res.stddev = ticks.size() > 1 ? ::std::sqrt(var / static_cast<double>(ticks.size() - 1)) : 0.;
+    return res;
+}
+
+/** Bootstrap a confidence interval for the ratio of the median durations of the reference over the candidate.
+ * @param reference Non-empty durations of the reference repetitions
+ * @param candidate Non-empty durations of the candidate repetitions
+ * @param seed      Seed of the resampling
+ * @param level     Confidence level (optional)
+ * @param nbsamples Number of bootstrap resamples (optional)
+ * @return Lower and upper bounds of the speedup
+**/
+static auto bootstrap_speedup(::std::vector<Chrono::Tick> const& reference, ::std::vector<Chrono::Tick> const& candidate, Seed seed, double level = 0.95, size_t nbsamples = 2000) {
+    ::std::minstd_rand engine{seed};
+    auto resample = [&](::std::vector<Chrono::Tick> const& ticks, ::std::vector<Chrono::Tick>& sample) {
+        ::std::uniform_int_distribution<size_t> pick{0, ticks.size() - 1};
+        sample.resize(ticks.size());
+        for (auto&& tick: sample)
+            tick = ticks[pick(engine)];
+        return median(sample);
+    };
+    ::std::vector<Chrono::Tick> sample;
+    ::std::vector<double> ratios(nbsamples);
+    for (auto&& ratio: ratios) {
+        auto ref = resample(reference, sample);
+        ratio = ref / resample(candidate, sample);
+    }
+    ::std::sort(ratios.begin(), ratios.end());
+    auto const low = static_cast<size_t>((1. - level) / 2. * static_cast<double>(nbsamples - 1));
+    auto const high = static_cast<size_t>((1. + level) / 2. * static_cast<double>(nbsamples - 1));
+    return ::std::make_pair(ratios[low], ratios[high]);
+}
+
+/** Print the abort accounting, total then per call site, each line prefixed with '⎪'.
+ * @param aborts Abort accounting to print
+**/
+static void print_aborts(Aborts const& aborts) {
+    auto print = [](Aborts::Site const& site) {
+        auto nbaborts = site.get_aborts();
+        auto nbattempts = nbaborts + site.commits;
+        ::std::cout << "⎪ " << site.name << " aborts: " << nbaborts << " (" << (nbattempts > 0 ? 100. * static_cast<double>(nbaborts) / static_cast<double>(nbattempts) : 0.) << "% of attempts; read " << site.aborts[static_cast<size_t>(Transaction::Op::read)] << ", write " << site.aborts[static_cast<size_t>(Transaction::Op::write)] << ", alloc " << site.aborts[static_cast<size_t>(Transaction::Op::alloc)] << ", free " << site.aborts[static_cast<size_t>(Transaction::Op::free)] << ", end " << site.aborts[static_cast<size_t>(Transaction::Op::end)] << "), wasted " << (static_cast<double>(site.wasted_tick) / 1000000.) << " ms and " << site.wasted_ops << " ops" << ::std::endl;
+    };
+    print(aborts.total());
+    for (auto&& site: aborts.get_sites())
+        print(site);
+}
+
+/** Print the hardware performance counters per committed transaction, on one line prefixed with '⎪'.
+ * @param counters Counters summed over the threads
+ * @param commits  Number of committed transactions
+**/
+static void print_counters(PerfCounters::Counts const& counters, uint_fast64_t commits) {
+    ::std::cout << "⎪ Per committed TX:";
+    for (size_t i = 0; i < PerfCounters::nbevents; ++i) {
+        auto const& count = counters.get(static_cast<PerfCounters::Event>(i));
+        ::std::cout << (i > 0 ? ", " : " ");
+        if (count && commits > 0) {
+            ::std::cout << (static_cast<double>(*count) / static_cast<double>(commits));
+        } else {
+            ::std::cout << "n/a";
+        }
+        ::std::cout << " " << PerfCounters::name(i);
+    }
+    auto const& cycles = counters.get(PerfCounters::cycles);
+    auto const& instructions = counters.get(PerfCounters::instructions);
+    if (cycles && instructions && *cycles > 0)
+        ::std::cout << " (IPC " << (static_cast<double>(*instructions) / static_cast<double>(*cycles)) << ")";
+    ::std::cout << ::std::endl;
+}
+
+/** Print a summary of a throughput timeline, on one line prefixed with '⎪'.
+ * @param timeline Samples of the timeline
+ * @param interval Sampling interval (in ns)
+**/
+static void print_timeline(::std::vector<Timeline::Sample> const& timeline, Chrono::Tick interval) {
+    ::std::vector<double> rates; // Throughput of each interval, the ones cut short excluded (in TX/s)
+    Chrono::Tick prev = 0;
+    for (auto&& sample: timeline) {
+        if (sample.tick - prev >= interval / 2)
+            rates.push_back(static_cast<double>(sample.commits) * 1000000000. / static_cast<double>(sample.tick - prev));
+        prev = sample.tick;
+    }
+    ::std::cout << "⎪ Throughput timeline: ";
+    if (rates.empty()) {
+        ::std::cout << "no complete interval" << ::std::endl;
+        return;
+    }
+    auto sorted = rates;
+    ::std::sort(sorted.begin(), sorted.end());
+    auto median = sorted[sorted.size() / 2];
+    auto stalls = ::std::count_if(rates.begin(), rates.end(), [&](double rate) { return rate < median / 2.; });
+    ::std::cout << rates.size() << " intervals of " << (static_cast<double>(interval) / 1000000.) << " ms, min " << sorted.front() << " TX/s, median " << median << " TX/s, max " << sorted.back() << " TX/s, " << stalls << " interval(s) under half the median" << ::std::endl;
+}
+
+/** Memory footprint of one measurement class.
+**/
+struct Footprint {
+    ::std::optional<uint_fast64_t> peak_rss; // Peak resident set size of the process during the measurement, empty if unavailable (in bytes)
+    ::std::optional<uint_fast64_t> base_rss; // Resident set size of the process before the measurement, empty if unavailable (in bytes)
+    uint_fast64_t minor_faults; // Number of minor page faults during the measurement
+    uint_fast64_t major_faults; // Number of major page faults during the measurement
+    int_fast64_t  heap; // Growth of the bytes in use in the memory allocator, mostly by the library, at the end of the measurement
+    uint_fast64_t live; // Bytes in the live shared segments at the end of the measurement, the first one included
+    /** Merge the footprint of another round of measurement of the same library.
+     * @param other Footprint of the other round, whose faults add up and whose peak or heap growth replace these if larger
+    **/
+    void merge(Footprint const& other) {
+        if (other.peak_rss && (!peak_rss || *other.peak_rss > *peak_rss)) {
+            peak_rss = other.peak_rss;
+            base_rss = other.base_rss;
+        }
+        minor_faults += other.minor_faults;
+        major_faults += other.major_faults;
+        if (other.heap > heap) {
+            heap = other.heap;
+            live = other.live;
+        }
+    }
+};
+
+/** Print the memory footprint, on one line prefixed with '⎪'.
+ * @param footprint Memory footprint to print
+**/
+static void print_footprint(Footprint const& footprint) {
+    auto mib = [](double bytes) { return bytes / 1048576.; };
+    ::std::cout << "⎪ Memory: peak RSS ";
+    if (footprint.peak_rss && footprint.base_rss) {
+        ::std::cout << mib(static_cast<double>(*footprint.peak_rss)) << " MiB (+" << mib(static_cast<double>(*footprint.peak_rss) - static_cast<double>(*footprint.base_rss)) << " MiB)";
+    } else {
+        ::std::cout << "n/a";
+    }
+    ::std::cout << ", " << footprint.minor_faults << " minor and " << footprint.major_faults << " major page faults, heap " << mib(static_cast<double>(footprint.heap)) << " MiB for " << mib(static_cast<double>(footprint.live)) << " MiB of live shared memory";
+    if (footprint.live > 0)
+        ::std::cout << " (" << (static_cast<double>(footprint.heap) / static_cast<double>(footprint.live)) << "x)";
+    ::std::cout << ::std::endl;
+}
+
+/** Print the per-kind statistics of the committed transactions, each line prefixed.
+ * @param stats Name and merged statistics of each kind of transaction
+ * @param last  Prefix of the last line ('⎩' closes the current block)
+**/
+static void print_stats(::std::vector<::std::pair<char const*, Statistics::Entry>> const& stats, char const* last) {
+    auto const percentiles = {50., 99., 99.9};
+    for (size_t i = 0; i < stats.size(); ++i) {
+        auto const& name = stats[i].first;
+        auto const& entry = stats[i].second;
+        ::std::cout << "⎪ " << name << " latency: ";
+        for (auto percent: percentiles)
+            ::std::cout << "p" << percent << " " << entry.latency.percentile(percent) << " ns, ";
+        ::std::cout << "max " << entry.latency.get_max() << " ns (" << entry.latency.get_count() << " commits)" << ::std::endl;
+        ::std::cout << (i + 1 < stats.size() ? "⎪ " : last) << name << " retries: ";
+        for (auto percent: percentiles)
+            ::std::cout << "p" << percent << " " << entry.retries.percentile(percent) << ", ";
+        ::std::cout << "max " << entry.retries.get_max() << ::std::endl;
+    }
+}
+
+/** Run parameters, as reported in the machine-readable outputs.
+**/
+struct Parameters {
+    Seed          seed;          // Seed value
+    ::std::vector<size_t> nbthreads; // Evaluated numbers of worker threads
+    ::std::vector<double> rates;     // Evaluated open-loop arrival rates (in TX/s), empty for closed loop
+    size_t        nbtx;          // Total number of transactions per repetition
+    unsigned int  nbwarmups;     // Number of discarded warmup repetitions
+    unsigned int  nbrepeats;     // Number of measured repetitions
+    bool          interleave;    // Whether the repetitions of the libraries are interleaved
+    bool          counters;      // Whether hardware performance counters are measured
+    bool          memory;        // Whether the memory footprint is measured
+    char const*   affinity;      // Placement policy of the worker threads
+    ::std::vector<int> cpus;     // Logical CPU of each worker thread, modulo its size (empty for no placement)
+    char const*   workload;      // Name of the workload
+    ::std::string settings;      // Settings specific to the workload, empty for the bank
+    size_t        nbaccounts;    // Initial number of accounts
+    size_t        expnbaccounts; // Expected number of accounts
+    unsigned long init_balance;  // Initial balance
+    float         prob_long;     // Long transaction probability
+    float         prob_alloc;    // Allocation transaction probability
+    ::std::string distribution;  // Distribution of the accounts of the short transactions
+    size_t        batch;         // Number of accounts per short transaction
+    unsigned long slow_factor;   // Slow trigger factor
+    Chrono::Tick  clk_res;       // Clock resolution (in ns), 'Chrono::invalid_tick' if unknown
+    Chrono::Tick  interval;      // Sampling interval of the throughput timelines (in ns), 0 for none
+public:
+    /** Tell whether the workload is the bank, the only one using the account parameters.
+     * @return Whether the workload is the bank
+    **/
+    bool is_bank() const noexcept {
+        return ::std::strcmp(workload, "bank") == 0;
+    }
+    /** Tell whether the workload draws its accounts or keys from the configured distribution.
+     * @return Whether the distribution is used
+    **/
+    bool has_distribution() const noexcept {
+        return is_bank() || ::std::strcmp(workload, "hashmap") == 0 || ::std::strcmp(workload, "skiplist") == 0;
+    }
+};
+
+/** Evaluation result of one library with one number of worker threads.
+**/
+struct Result {
+    char const*   path;       // Path of the library
+    bool          reference;  // Whether the library is the reference
+    size_t        nbthreads;  // Number of worker threads
+    size_t        nbtxperwrk; // Number of transactions per worker
+    double        rate;       // Open-loop arrival rate, over every worker (in TX/s), 0 for closed loop
+    char const*   error;      // Error constant null-terminated string ('nullptr' for none)
+    Chrono::Tick  tick_init;  // Initialization duration, of the first measurement (in ns)
+    ::std::vector<Chrono::Tick> ticks; // Duration of each measured repetition, in order (in ns)
+    Chrono::Tick  tick_chck;  // Correctness check duration, of the first measurement (in ns)
+    Summary       summary;    // Summary statistics of the repetitions
+    double        speedup;    // Ratio of the median durations of the reference over the library
+    double        speedup_low;  // Lower bound of the speedup confidence interval (NaN for the reference)
+    double        speedup_high; // Upper bound of the speedup confidence interval (NaN for the reference)
+    Aborts        aborts;     // Abort accounting
+    PerfCounters::Counts counters; // Hardware performance counters, summed over the threads
+    ::std::vector<::std::pair<char const*, Statistics::Entry>> stats; // Statistics of each kind of transaction
+    ::std::vector<::std::pair<char const*, double>> metrics; // Workload-specific metrics, averaged over the measured rounds
+    Histogram     latency;    // Open-loop latency, from the intended start of each transaction (in ns)
+    ::std::vector<Timeline::Sample> timeline; // Throughput timeline of every round, concatenated without the time between them
+    ::std::vector<Chrono::Tick> starts; // Start of each repetition in the timeline (in ns)
+    Footprint     footprint;  // Memory footprint, merged over the rounds
+};
+
+/** Write a string as a JSON string literal.
+ * @param out  Output stream
+ * @param text Null-terminated string to write
+**/
+static void print_json_string(::std::ostream& out, char const* text) {
+    out << '"';
+    for (; *text != '\0'; ++text) {
+        auto c = static_cast<unsigned char>(*text);
+        if (c == '"' || c == '\\') {
+            out << '\\' << *text;
+        } else if (c < 0x20) {
+            out << "\\u" << ::std::hex << ::std::setw(4) << ::std::setfill('0') << static_cast<unsigned int>(c) << ::std::dec << ::std::setfill(' ');
+        } else {
+            out << *text;
+        }
+    }
+    out << '"';
+}
+
+/** Write the run parameters and every result as one JSON document.
+ * @param out     Output stream
+ * @param params  Run parameters
+ * @param results Results to write
+**/
+static void print_json(::std::ostream& out, Parameters const& params, ::std::vector<Result> const& results) {
+    auto const percentiles = {50., 99., 99.9};
+    out << "{\"parameters\":{\"seed\":" << params.seed << ",\"threads\":[";
+    for (size_t i = 0; i < params.nbthreads.size(); ++i)
+        out << (i > 0 ? "," : "") << params.nbthreads[i];
+    out << "],\"rates\":[";
+    for (size_t i = 0; i < params.rates.size(); ++i)
+        out << (i > 0 ? "," : "") << params.rates[i];
+    out << "],\"tx_per_repetition\":" << params.nbtx << ",\"warmups\":" << params.nbwarmups << ",\"repetitions\":" << params.nbrepeats << ",\"interleave\":" << (params.interleave ? "true" : "false") << ",\"counters\":" << (params.counters ? "true" : "false") << ",\"memory\":" << (params.memory ? "true" : "false") << ",\"affinity\":";
+    print_json_string(out, params.affinity);
+    out << ",\"cpus\":[";
+    for (size_t i = 0; i < params.cpus.size(); ++i)
+        out << (i > 0 ? "," : "") << params.cpus[i];
+    out << "],\"workload\":";
+    print_json_string(out, params.workload);
+    out << ",\"workload_settings\":";
+    print_json_string(out, params.settings.c_str());
+    if (params.is_bank()) {
+        out << ",\"initial_accounts\":" << params.nbaccounts << ",\"expected_accounts\":" << params.expnbaccounts << ",\"initial_balance\":" << params.init_balance << ",\"prob_long\":" << params.prob_long << ",\"prob_alloc\":" << params.prob_alloc;
+    } else {
+        out << ",\"initial_accounts\":null,\"expected_accounts\":null,\"initial_balance\":null,\"prob_long\":null,\"prob_alloc\":null";
+    }
+    out << ",\"distribution\":";
+    if (params.has_distribution()) {
+        print_json_string(out, params.distribution.c_str());
+    } else {
+        out << "null";
+    }
+    out << ",\"batch\":";
+    if (params.is_bank()) {
+        out << params.batch;
+    } else {
+        out << "null";
+    }
+    out << ",\"slow_factor\":" << params.slow_factor << ",\"clock_resolution_ns\":";
+    if (params.clk_res == Chrono::invalid_tick) {
+        out << "null";
+    } else {
+        out << params.clk_res;
+    }
+    out << ",\"timeline_interval_ns\":";
+    if (params.interval > 0) {
+        out << params.interval;
+    } else {
+        out << "null";
+    }
+    out << "},\"results\":[" << ::std::setprecision(15);
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto const& res = results[i];
+        out << (i > 0 ? "," : "") << "{\"library\":";
+        print_json_string(out, res.path);
+        out << ",\"reference\":" << (res.reference ? "true" : "false") << ",\"threads\":" << res.nbthreads << ",\"tx_per_worker\":" << res.nbtxperwrk << ",\"rate\":";
+        if (res.rate > 0.) {
+            out << res.rate;
+        } else {
+            out << "null";
+        }
+        out << ",\"error\":";
+        if (res.error) {
+            print_json_string(out, res.error);
+            out << "}";
+            continue;
+        }
+        out << "null,\"init_ns\":" << res.tick_init << ",\"times_ns\":[";
+        for (size_t j = 0; j < res.ticks.size(); ++j)
+            out << (j > 0 ? "," : "") << res.ticks[j];
+        auto aborts = res.aborts.total();
+        out << "],\"median_ns\":" << res.summary.median << ",\"trimmed_mean_ns\":" << res.summary.trimmed << ",\"stddev_ns\":" << res.summary.stddev << ",\"check_ns\":" << res.tick_chck << ",\"speedup\":" << res.speedup << ",\"speedup_ci\":";
+        if (::std::isnan(res.speedup_low)) {
+            out << "null";
+        } else {
+            out << "[" << res.speedup_low << "," << res.speedup_high << "]";
+        }
+        if (params.counters) {
+            out << ",\"counters\":{";
+            for (size_t j = 0; j < PerfCounters::nbevents; ++j) {
+                auto const& count = res.counters.get(static_cast<PerfCounters::Event>(j));
+                out << (j > 0 ? "," : "");
+                print_json_string(out, PerfCounters::name(j));
+                out << ":";
+                if (count) {
+                    out << *count;
+                } else {
+                    out << "null";
+                }
+            }
+            out << "}";
+        }
+        if (params.memory) {
+            auto const& footprint = res.footprint;
+            auto optional = [&](::std::optional<uint_fast64_t> const& value) {
+                if (value) {
+                    out << *value;
+                } else {
+                    out << "null";
+                }
+            };
+            out << ",\"memory\":{\"peak_rss_bytes\":";
+            optional(footprint.peak_rss);
+            out << ",\"base_rss_bytes\":";
+            optional(footprint.base_rss);
+            out << ",\"minor_faults\":" << footprint.minor_faults << ",\"major_faults\":" << footprint.major_faults << ",\"heap_bytes\":" << footprint.heap << ",\"live_shared_bytes\":" << footprint.live << "}";
+        }
+        out << ",\"aborts\":{\"total\":" << aborts.get_aborts() << ",\"commits\":" << aborts.commits << ",\"wasted_ns\":" << aborts.wasted_tick << ",\"wasted_ops\":" << aborts.wasted_ops << "},\"transactions\":{";
+        for (size_t j = 0; j < res.stats.size(); ++j) {
+            auto const& entry = res.stats[j].second;
+            out << (j > 0 ? "," : "");
+            print_json_string(out, res.stats[j].first);
+            out << ":{\"commits\":" << entry.latency.get_count() << ",\"latency_ns\":{";
+            for (auto percent: percentiles)
+                out << "\"p" << percent << "\":" << entry.latency.percentile(percent) << ",";
+            out << "\"max\":" << entry.latency.get_max() << "},\"retries\":{";
+            for (auto percent: percentiles)
+                out << "\"p" << percent << "\":" << entry.retries.percentile(percent) << ",";
+            out << "\"max\":" << entry.retries.get_max() << "}}";
+        }
+        out << "}";
+        if (res.rate > 0.) {
+            out << ",\"open_loop\":{\"achieved_tx_per_s\":" << (static_cast<double>(res.nbthreads * res.nbtxperwrk) * 1000000000. / res.summary.median) << ",\"latency_ns\":{";
+            for (auto percent: percentiles)
+                out << "\"p" << percent << "\":" << res.latency.percentile(percent) << ",";
+            out << "\"max\":" << res.latency.get_max() << "}}";
+        }
+        if (!res.timeline.empty()) {
+            out << ",\"timeline\":{\"starts_ns\":[";
+            for (size_t j = 0; j < res.starts.size(); ++j)
+                out << (j > 0 ? "," : "") << res.starts[j];
+            out << "],\"ticks_ns\":[";
+            for (size_t j = 0; j < res.timeline.size(); ++j)
+                out << (j > 0 ? "," : "") << res.timeline[j].tick;
+            out << "],\"commits\":[";
+            for (size_t j = 0; j < res.timeline.size(); ++j)
+                out << (j > 0 ? "," : "") << res.timeline[j].commits;
+            out << "]}";
+        }
+        if (!res.metrics.empty()) {
+            out << ",\"metrics\":{";
+            for (size_t j = 0; j < res.metrics.size(); ++j) {
+                out << (j > 0 ? "," : "");
+                print_json_string(out, res.metrics[j].first);
+                out << ":" << res.metrics[j].second;
+            }
+            out << "}";
+        }
+        out << "}";
+    }
+    out << "]}" << ::std::endl;
+}
+
+/** Write the run parameters and every result as CSV, one row per repetition.
+ * @param out     Output stream
+ * @param params  Run parameters
+ * @param results Results to write
+**/
+static void print_csv(::std::ostream& out, Parameters const& params, ::std::vector<Result> const& results) {
+    out << "seed,tx_per_repetition,warmups,repetitions,interleave,affinity,workload,workload_settings,initial_accounts,expected_accounts,initial_balance,prob_long,prob_alloc,distribution,batch,library,reference,threads,tx_per_worker,rate,error,init_ns,check_ns,median_ns,trimmed_mean_ns,stddev_ns,speedup,speedup_low,speedup_high,aborts,wasted_ns,wasted_ops,cycles,instructions,llc_misses,branch_misses,context_switches,open_p50_ns,open_p99_ns,open_p999_ns,peak_rss_bytes,minor_faults,major_faults,heap_bytes,live_shared_bytes,repetition,time_ns" << ::std::endl;
+    for (auto&& res: results) {
+        auto row = [&]() -> ::std::ostream& {
+            out << ::std::setprecision(6) << params.seed << "," << params.nbtx << "," << params.nbwarmups << "," << params.nbrepeats << "," << (params.interleave ? 1 : 0) << ",";
+            print_json_string(out, params.affinity);
+            out << ",";
+            print_json_string(out, params.workload);
+            out << ",";
+            print_json_string(out, params.settings.c_str());
+            out << ",";
+            if (params.is_bank())
+                out << params.nbaccounts << "," << params.expnbaccounts << "," << params.init_balance << "," << params.prob_long << "," << params.prob_alloc;
+            else
+                out << ",,,,";
+            out << ",";
+            if (params.has_distribution())
+                print_json_string(out, params.distribution.c_str());
+            out << ",";
+            if (params.is_bank())
+                out << params.batch;
+            out << ",";
+            print_json_string(out, res.path); // Same quoting rules for the usual paths
+            out << "," << (res.reference ? 1 : 0) << "," << res.nbthreads << "," << res.nbtxperwrk << "," << ::std::setprecision(15);
+            if (res.rate > 0.)
+                out << res.rate;
+            out << ",";
+            if (res.error) {
+                print_json_string(out, res.error);
+                return out << ",,,,,,,,,,,,,,,,,,,,,,,,,,";
+            }
+            auto aborts = res.aborts.total();
+            out << "," << res.tick_init << "," << res.tick_chck << "," << res.summary.median << "," << res.summary.trimmed << "," << res.summary.stddev << "," << res.speedup << ",";
+            if (::std::isnan(res.speedup_low)) {
+                out << ",";
+            } else {
+                out << res.speedup_low << "," << res.speedup_high;
+            }
+            out << "," << aborts.get_aborts() << "," << aborts.wasted_tick << "," << aborts.wasted_ops << ",";
+            for (size_t j = 0; j < PerfCounters::nbevents; ++j) {
+                auto const& count = res.counters.get(static_cast<PerfCounters::Event>(j));
+                if (count)
+                    out << *count;
+                out << ",";
+            }
+            if (res.rate > 0.) {
+                out << res.latency.percentile(50.) << "," << res.latency.percentile(99.) << "," << res.latency.percentile(99.9);
+            } else {
+                out << ",,";
+            }
+            out << ",";
+            if (params.memory) {
+                if (res.footprint.peak_rss)
+                    out << *res.footprint.peak_rss;
+                out << "," << res.footprint.minor_faults << "," << res.footprint.major_faults << "," << res.footprint.heap << "," << res.footprint.live;
+            } else {
+                out << ",,,,";
+            }
+            return out << ",";
+        };
+        if (res.error) {
+            row() << ::std::endl;
+            continue;
+        }
+        for (size_t i = 0; i < res.ticks.size(); ++i)
+            row() << i << "," << res.ticks[i] << ::std::endl;
+    }
+}
+
+/** Print the scaling table of one library over the swept thread counts.
+ * @param path      Path of the library
+ * @param nbthreads Thread counts evaluated
+ * @param ticks     Median repetition duration for each thread count (in ns)
+ * @param nbtx      Total number of transactions per repetition, for every thread count
+**/
+static void print_scaling(char const* path, ::std::vector<size_t> const& nbthreads, ::std::vector<double> const& ticks, size_t nbtx) {
+    auto throughput = [&](size_t i) { // In committed TX per second
+        return static_cast<double>(nbtx / nbthreads[i] * nbthreads[i]) * 1000000000. / ticks[i];
+    };
+    ::std::cout << "⎧ Scaling of '" << path << "':" << ::std::endl;
+    ::std::cout << "⎪ " << ::std::setw(8) << "threads" << ::std::setw(14) << "time (ms)" << ::std::setw(20) << "throughput (TX/s)" << ::std::setw(10) << "speedup" << ::std::setw(12) << "efficiency" << ::std::endl;
+    for (size_t i = 0; i < ticks.size(); ++i) {
+        auto speedup = throughput(i) / throughput(0); // The sweep starts with a single thread
+        ::std::cout << (i + 1 < ticks.size() ? "⎪ " : "⎩ ") << ::std::fixed << ::std::setprecision(2)
+            << ::std::setw(8) << nbthreads[i]
+            << ::std::setw(14) << (ticks[i] / 1000000.)
+            << ::std::setw(20) << throughput(i)
+            << ::std::setw(10) << speedup
+            << ::std::setw(12) << (speedup / static_cast<double>(nbthreads[i]))
+            << ::std::defaultfloat << ::std::setprecision(6) << ::std::endl;
+    }
+}
+
+/** Print the latency versus throughput table of one library over the swept arrival rates.
+ * @param path    Path of the library
+ * @param results Results of the library, in the order of the sweep
+**/
+static void print_open_loop(char const* path, ::std::vector<Result const*> const& results) {
+    ::std::cout << "⎧ Latency versus throughput of '" << path << "':" << ::std::endl;
+    ::std::cout << "⎪ " << ::std::setw(16) << "offered (TX/s)" << ::std::setw(17) << "achieved (TX/s)" << ::std::setw(12) << "p50 (us)" << ::std::setw(12) << "p99 (us)" << ::std::setw(13) << "p99.9 (us)" << ::std::setw(12) << "max (us)" << ::std::endl;
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto const& res = *results[i];
+        ::std::cout << (i + 1 < results.size() ? "⎪ " : "⎩ ") << ::std::fixed << ::std::setprecision(2)
+            << ::std::setw(16) << res.rate
+            << ::std::setw(17) << (static_cast<double>(res.nbthreads * res.nbtxperwrk) * 1000000000. / res.summary.median)
+            << ::std::setw(12) << (static_cast<double>(res.latency.percentile(50.)) / 1000.)
+            << ::std::setw(12) << (static_cast<double>(res.latency.percentile(99.)) / 1000.)
+            << ::std::setw(13) << (static_cast<double>(res.latency.percentile(99.9)) / 1000.)
+            << ::std::setw(12) << (static_cast<double>(res.latency.get_max()) / 1000.)
+            << ::std::defaultfloat << ::std::setprecision(6) << ::std::endl;
+    }
+}
+
 // -------------------------------------------------------------------------- //
 
 /** Program entry point.
@@ -248,8 +986,111 @@ static auto measure(Workload& workload, unsigned int const nbthreads, unsigned i
 int main(int argc, char** argv) {
     try {
         // Parse command line option(s)
-        if (argc < 3) {
-            ::std::cout << "Usage: " << (argc > 0 ? argv[0] : "grading") << " <seed> <reference library path> <tested library path>..." << ::std::endl;
+        auto sweep = false; // Whether to sweep over thread counts
+        auto format = "text"; // Output format
+        auto nbwarmups = 0u;  // Number of discarded warmup repetitions
+        auto nbrepeats = 7u;  // Number of measured repetitions
+        auto interleave = false; // Whether to interleave the repetitions of the libraries
+        auto affinity = "none";  // Placement policy of the worker threads
+        auto counters = false;   // Whether to measure hardware performance counters
+        auto memory = false;     // Whether to measure the memory footprint
+        auto workload = "bank"; // Name of the workload
+        auto mix = ::std::vector<unsigned int>{80, 10, 10}; // Relative weights of the lookup, insert and delete operations of the hash map and skip list
+        auto distribution = AccountDistribution::uniform(); // Distribution of the accounts of the short transactions, or of the keys
+        auto batch = 2ul; // Number of accounts read and written per short transaction
+        char const* record = nullptr; // Path of the trace file to record, 'nullptr' for none
+        ::std::unique_ptr<TraceFile> replay; // Trace to replay, with the 'replay' workload
+        auto rates = ::std::vector<double>{}; // Open-loop arrival rates to sweep (in TX/s), empty for closed loop
+        auto interval = Chrono::Tick{0}; // Sampling interval of the throughput timelines (in ns), 0 for none
+        auto argi = 1;
+        for (; argi < argc && ::std::strncmp(argv[argi], "--", 2) == 0; ++argi) {
+            if (::std::strcmp(argv[argi], "--sweep") == 0) {
+                sweep = true;
+            } else if (::std::strncmp(argv[argi], "--warmups=", ::std::strlen("--warmups=")) == 0) {
+                nbwarmups = ::std::stoul(argv[argi] + ::std::strlen("--warmups="));
+            } else if (::std::strncmp(argv[argi], "--repeats=", ::std::strlen("--repeats=")) == 0) {
+                nbrepeats = ::std::stoul(argv[argi] + ::std::strlen("--repeats="));
+                if (nbrepeats == 0) {
+                    ::std::cout << "At least one repetition is required" << ::std::endl;
+                    return 1;
+                }
+            } else if (::std::strcmp(argv[argi], "--interleave") == 0) {
+                interleave = true;
+            } else if (::std::strcmp(argv[argi], "--counters") == 0) {
+                counters = true;
+            } else if (::std::strcmp(argv[argi], "--memory") == 0) {
+                memory = true;
+            } else if (::std::strncmp(argv[argi], "--zipf=", ::std::strlen("--zipf=")) == 0) {
+                auto theta = ::std::stod(argv[argi] + ::std::strlen("--zipf="));
+                if (!(theta >= 0. && theta < 1.)) {
+                    ::std::cout << "The Zipf skew must be in [0, 1)" << ::std::endl;
+                    return 1;
+                }
+                distribution = AccountDistribution::zipf(theta);
+            } else if (::std::strncmp(argv[argi], "--hotset=", ::std::strlen("--hotset=")) == 0) {
+                size_t pos;
+                auto text = ::std::string{argv[argi] + ::std::strlen("--hotset=")};
+                auto fraction = ::std::stod(text, &pos);
+                auto prob = (pos < text.size() && text[pos] == ',') ? ::std::stod(text.substr(pos + 1)) : -1.;
+                if (!(fraction > 0. && fraction <= 1. && prob >= 0. && prob <= 1.)) {
+                    ::std::cout << "The hot set must be given as <fraction in (0, 1]>,<probability in [0, 1]>" << ::std::endl;
+                    return 1;
+                }
+                distribution = AccountDistribution::hotset(fraction, prob);
+            } else if (::std::strcmp(argv[argi], "--workload=bank") == 0 || ::std::strcmp(argv[argi], "--workload=hashmap") == 0 || ::std::strcmp(argv[argi], "--workload=skiplist") == 0 || ::std::strcmp(argv[argi], "--workload=queue") == 0 || ::std::strcmp(argv[argi], "--workload=vacation") == 0 || ::std::strcmp(argv[argi], "--workload=kmeans") == 0 || ::std::strcmp(argv[argi], "--workload=config") == 0) {
+                workload = argv[argi] + ::std::strlen("--workload=");
+            } else if (::std::strncmp(argv[argi], "--mix=", ::std::strlen("--mix=")) == 0) {
+                ::std::istringstream text{argv[argi] + ::std::strlen("--mix=")};
+                mix.clear();
+                for (::std::string weight; ::std::getline(text, weight, ',');)
+                    mix.push_back(::std::stoul(weight));
+                if (mix.size() != 3 || mix[0] + mix[1] + mix[2] == 0) {
+                    ::std::cout << "The operation mix must be given as <lookup weight>,<insert weight>,<delete weight>, not all null" << ::std::endl;
+                    return 1;
+                }
+            } else if (::std::strncmp(argv[argi], "--batch=", ::std::strlen("--batch=")) == 0) {
+                batch = ::std::stoul(argv[argi] + ::std::strlen("--batch="));
+                if (batch < 2) {
+                    ::std::cout << "A transfer involves at least 2 accounts" << ::std::endl;
+                    return 1;
+                }
+            } else if (::std::strncmp(argv[argi], "--record=", ::std::strlen("--record=")) == 0) {
+                record = argv[argi] + ::std::strlen("--record=");
+            } else if (::std::strncmp(argv[argi], "--replay=", ::std::strlen("--replay=")) == 0) {
+                replay = ::std::make_unique<TraceFile>(argv[argi] + ::std::strlen("--replay="));
+                workload = "replay";
+            } else if (::std::strncmp(argv[argi], "--rates=", ::std::strlen("--rates=")) == 0) {
+                ::std::istringstream text{argv[argi] + ::std::strlen("--rates=")};
+                rates.clear();
+                for (::std::string rate; ::std::getline(text, rate, ',');) {
+                    rates.push_back(::std::stod(rate));
+                    if (!(rates.back() > 0.)) {
+                        ::std::cout << "The arrival rates must be positive" << ::std::endl;
+                        return 1;
+                    }
+                }
+            } else if (::std::strncmp(argv[argi], "--timeline=", ::std::strlen("--timeline=")) == 0) {
+                auto ms = ::std::stod(argv[argi] + ::std::strlen("--timeline="));
+                if (!(ms >= 0.1)) {
+                    ::std::cout << "The timeline sampling interval must be at least 0.1 ms" << ::std::endl;
+                    return 1;
+                }
+                interval = static_cast<Chrono::Tick>(ms * 1000000.);
+            } else if (::std::strncmp(argv[argi], "--affinity=", ::std::strlen("--affinity=")) == 0) {
+                affinity = argv[argi] + ::std::strlen("--affinity=");
+            } else if (::std::strcmp(argv[argi], "--format=text") == 0 || ::std::strcmp(argv[argi], "--format=json") == 0 || ::std::strcmp(argv[argi], "--format=csv") == 0) {
+                format = argv[argi] + ::std::strlen("--format=");
+            } else {
+                ::std::cout << "Unknown option '" << argv[argi] << "'" << ::std::endl;
+                return 1;
+            }
+        }
+        if (argc - argi < 2) {
+            ::std::cout << "Usage: " << (argc > 0 ? argv[0] : "grading") << " [--sweep] [--workload=bank|hashmap|skiplist|queue|vacation|kmeans|config] [--format=text|json|csv] [--warmups=<count>] [--repeats=<count>] [--interleave] [--affinity=none|compact|scatter|cores|<CPU list>] [--counters] [--memory] [--zipf=<theta>|--hotset=<fraction>,<probability>] [--batch=<accounts>] [--mix=<lookup>,<insert>,<delete>] [--record=<trace path>] [--replay=<trace path>] [--rates=<TX/s>,...] [--timeline=<ms>] <seed> <reference library path> <tested library path>..." << ::std::endl;
+            return 1;
+        }
+        if (sweep && !rates.empty()) {
+            ::std::cout << "Sweeping both the thread counts and the arrival rates is not supported" << ::std::endl;
             return 1;
         }
         // Get/set/compute run parameters
@@ -259,25 +1100,127 @@ int main(int argc, char** argv) {
                 res = 16;
             return static_cast<size_t>(res);
         }();
-        auto const nbtxperwrk    = 200000ul / nbworkers;
+        auto const nbtx          = 200000ul;
         auto const nbaccounts    = 32 * nbworkers;
         auto const expnbaccounts = 256 * nbworkers;
         auto const init_balance  = 100ul;
+        auto const nbkeys        = 1024 * nbworkers;
+        auto const nbslots       = 64ul;
+        auto const nbrelations   = 1024 * nbworkers;
+        auto const nbqueries     = 4ul;  // As STAMP's high-contention vacation configuration
+        auto const query_range   = 60ul; // Percentage of the relations queried
+        auto const prob_user     = 0.9f;
+        auto const nbclusters    = 15ul; // As STAMP's high-contention kmeans configuration
+        auto const nbdims        = 16ul;
+        auto const nbpoints      = 1024ul; // Per worker and per iteration
+        auto const cache_size    = 32ul << 20; // Size of the configuration cache (in bytes)
+        auto const nbscanned     = 128ul;      // Records of 64 bytes read per scan
+        auto const nbupdated     = 4ul;        // Records rewritten per update
+        auto const prob_update   = 0.01f;
         auto const prob_long     = 0.5f;
         auto const prob_alloc    = 0.01f;
-        auto const nbrepeats     = 7;
-        auto const seed          = static_cast<Seed>(::std::stoul(argv[1]));
+        auto const seed          = static_cast<Seed>(::std::stoul(argv[argi]));
         auto const clk_res       = Chrono::get_resolution();
         auto const slow_factor   = 8ul;
+        auto const nbthreads     = [&]() { // Thread counts to evaluate, the workload size only depends on 'nbworkers'
+            ::std::vector<size_t> res;
+            if (!sweep) {
+                res.push_back(nbworkers);
+                return res;
+            }
+            for (size_t count = 1; count < nbworkers; count *= 2)
+                res.push_back(count);
+            res.push_back(nbworkers);
+            res.push_back(2 * nbworkers); // Oversubscribed
+            res.push_back(4 * nbworkers);
+            return res;
+        }();
+        Topology const topology;
+        auto const cpus = ::std::strcmp(affinity, "none") == 0 ? ::std::vector<int>{} : topology.order(affinity);
+        auto const settings = [&]() { // Human-readable settings specific to the workload
+            ::std::ostringstream res;
+            if (::std::strcmp(workload, "hashmap") == 0)
+                res << nbkeys << " keys, get/put/delete mix " << mix[0] << "/" << mix[1] << "/" << mix[2];
+            if (::std::strcmp(workload, "skiplist") == 0)
+                res << nbkeys << " keys, contains/insert/remove mix " << mix[0] << "/" << mix[1] << "/" << mix[2];
+            if (::std::strcmp(workload, "queue") == 0)
+                res << nbslots << " slots, even workers enqueue and odd ones dequeue";
+            if (::std::strcmp(workload, "vacation") == 0)
+                res << nbrelations << " relations per table, " << nbqueries << " queries per TX over " << query_range << "% of them, " << prob_user * 100 << "% reservations";
+            if (::std::strcmp(workload, "kmeans") == 0)
+                res << nbclusters << " clusters, " << nbdims << " dimensions, " << nbpoints << " points per worker and iteration";
+            if (::std::strcmp(workload, "config") == 0)
+                res << (cache_size >> 20) << " MiB, " << nbscanned << " records per scan, " << nbupdated << " records per update, " << prob_update * 100 << "% updates";
+            if (::std::strcmp(workload, "replay") == 0)
+                res << replay->count() << " TX recorded by " << replay->get_nbthreads() << " thread(s), " << replay->get_size() << " bytes plus " << replay->get_folded() << " folded bytes";
+            return res.str();
+        }();
+        auto const make_workload = [&](TransactionalLibrary const& tl, size_t nbthread, size_t nbtxperthr) -> ::std::unique_ptr<Workload> {
+            if (::std::strcmp(workload, "hashmap") == 0)
+                return ::std::make_unique<WorkloadHashMap>(tl, nbthread, nbtxperthr, nbkeys, mix, distribution);
+            if (::std::strcmp(workload, "skiplist") == 0)
+                return ::std::make_unique<WorkloadSkipList>(tl, nbthread, nbtxperthr, nbkeys, mix, distribution);
+            if (::std::strcmp(workload, "queue") == 0)
+                return ::std::make_unique<WorkloadQueue>(tl, nbthread, nbtxperthr, nbslots);
+            if (::std::strcmp(workload, "vacation") == 0)
+                return ::std::make_unique<WorkloadVacation>(tl, nbthread, nbtxperthr, nbrelations, nbqueries, query_range, prob_user);
+            if (::std::strcmp(workload, "kmeans") == 0)
+                return ::std::make_unique<WorkloadKMeans>(tl, nbthread, nbtxperthr, nbclusters, nbdims, nbpoints);
+            if (::std::strcmp(workload, "replay") == 0)
+                return ::std::make_unique<WorkloadReplay>(tl, nbthread, nbtxperthr, *replay);
+            if (::std::strcmp(workload, "config") == 0)
+                return ::std::make_unique<WorkloadConfigCache>(tl, nbthread, nbtxperthr, cache_size, nbscanned, nbupdated, prob_update);
+            return ::std::make_unique<WorkloadBank>(tl, nbthread, nbtxperthr, nbaccounts, expnbaccounts, init_balance, prob_long, prob_alloc, distribution, batch);
+        };
+        Parameters const params{seed, nbthreads, rates, nbtx, nbwarmups, nbrepeats, interleave, counters, memory, affinity, cpus, workload, settings, nbaccounts, expnbaccounts, init_balance, prob_long, prob_alloc, distribution.describe(), batch, slow_factor, clk_res, interval};
+        // Mute the human-readable text when writing a machine-readable output at the end
+        ::std::vector<Result> results;
+        auto const textbuf = ::std::cout.rdbuf();
+        auto const emit = [&]() {
+            if (::std::strcmp(format, "text") == 0)
+                return;
+            ::std::cout.rdbuf(textbuf);
+            if (::std::strcmp(format, "json") == 0) {
+                print_json(::std::cout, params, results);
+            } else {
+                print_csv(::std::cout, params, results);
+            }
+        };
+        if (::std::strcmp(format, "text") != 0)
+            ::std::cout.rdbuf(nullptr);
         // Print run parameters
-        ::std::cout << "⎧ #worker threads:     " << nbworkers << ::std::endl;
-        ::std::cout << "⎪ #TX per worker:      " << nbtxperwrk << ::std::endl;
-        ::std::cout << "⎪ #repetitions:        " << nbrepeats << ::std::endl;
-        ::std::cout << "⎪ Initial #accounts:   " << nbaccounts << ::std::endl;
-        ::std::cout << "⎪ Expected #accounts:  " << expnbaccounts << ::std::endl;
-        ::std::cout << "⎪ Initial balance:     " << init_balance << ::std::endl;
-        ::std::cout << "⎪ Long TX probability: " << prob_long << ::std::endl;
-        ::std::cout << "⎪ Allocation TX prob.: " << prob_alloc << ::std::endl;
+        ::std::cout << "⎧ #worker threads:     ";
+        for (size_t i = 0; i < nbthreads.size(); ++i)
+            ::std::cout << (i > 0 ? ", " : "") << nbthreads[i];
+        ::std::cout << ::std::endl;
+        ::std::cout << "⎪ #TX per worker:      ";
+        for (size_t i = 0; i < nbthreads.size(); ++i)
+            ::std::cout << (i > 0 ? ", " : "") << nbtx / nbthreads[i];
+        ::std::cout << ::std::endl;
+        ::std::cout << "⎪ #warmups:            " << nbwarmups << ::std::endl;
+        ::std::cout << "⎪ #repetitions:        " << nbrepeats << (interleave ? " (interleaved)" : "") << ::std::endl;
+        ::std::cout << "⎪ Arrival rates:       ";
+        if (rates.empty()) {
+            ::std::cout << "closed loop" << ::std::endl;
+        } else {
+            for (size_t i = 0; i < rates.size(); ++i)
+                ::std::cout << (i > 0 ? ", " : "open loop, ") << rates[i];
+            ::std::cout << " TX/s (Poisson)" << ::std::endl;
+        }
+        ::std::cout << "⎪ Workload:            " << workload << (settings.empty() ? "" : " (" + settings + ")") << ::std::endl;
+        if (::std::strcmp(workload, "bank") == 0) {
+            ::std::cout << "⎪ Initial #accounts:   " << nbaccounts << ::std::endl;
+            ::std::cout << "⎪ Expected #accounts:  " << expnbaccounts << ::std::endl;
+            ::std::cout << "⎪ Initial balance:     " << init_balance << ::std::endl;
+            ::std::cout << "⎪ Long TX probability: " << prob_long << ::std::endl;
+            ::std::cout << "⎪ Allocation TX prob.: " << prob_alloc << ::std::endl;
+            ::std::cout << "⎪ Account distrib.:    " << distribution.describe() << ::std::endl;
+            ::std::cout << "⎪ Accounts per TX:     " << batch << (batch > 2 ? " (batch)" : "") << ::std::endl;
+        } else if (::std::strcmp(workload, "hashmap") == 0 || ::std::strcmp(workload, "skiplist") == 0) {
+            ::std::cout << "⎪ Key distribution:    " << distribution.describe() << ::std::endl;
+        }
+        if (interval > 0)
+            ::std::cout << "⎪ Timeline interval:   " << (static_cast<double>(interval) / 1000000.) << " ms" << ::std::endl;
         ::std::cout << "⎪ Slow trigger factor: " << slow_factor << ::std::endl;
         ::std::cout << "⎪ Clock resolution:    ";
         if (unlikely(clk_res == Chrono::invalid_tick)) {
@@ -285,56 +1228,211 @@ int main(int argc, char** argv) {
         } else {
             ::std::cout << clk_res << " ns" << ::std::endl;
         }
+        ::std::cout << "⎪ Topology:            " << topology.count_packages() << " package(s), " << topology.count_cores() << " core(s), " << topology.get_cpus().size() << " CPU(s)" << ::std::endl;
+        ::std::cout << "⎪ Thread placement:    " << affinity;
+        if (!cpus.empty()) {
+            ::std::cout << " (CPUs";
+            for (size_t i = 0; i < cpus.size(); ++i)
+                ::std::cout << (i > 0 ? ", " : " ") << cpus[i];
+            ::std::cout << ")";
+        }
+        ::std::cout << ::std::endl;
         ::std::cout << "⎩ Seed value:          " << seed << ::std::endl;
         // Library evaluations
-        double reference = 0.; // Set to avoid irrelevant '-Wmaybe-uninitialized'
-        auto const pertxdiv = static_cast<double>(nbworkers) * static_cast<double>(nbtxperwrk);
-        auto maxtick_init = Chrono::invalid_tick;
-        auto maxtick_perf = Chrono::invalid_tick;
-        auto maxtick_chck = Chrono::invalid_tick;
-        for (auto i = 2; i < argc; ++i) {
-            ::std::cout << "⎧ Evaluating '" << argv[i] << "'" << (maxtick_init == Chrono::invalid_tick ? " (reference)" : "") << "..." << ::std::endl;
-            // Load TM library
-            TransactionalLibrary tl{argv[i]};
-            // Initialize workload (shared memory lifetime bound to workload: created and destroyed at the same time)
-            WorkloadBank bank{tl, nbworkers, nbtxperwrk, nbaccounts, expnbaccounts, init_balance, prob_long, prob_alloc};
-            try {
-                // Actual performance measurements and correctness check
-                auto res = measure(bank, nbworkers, nbrepeats, seed, maxtick_init, maxtick_perf, maxtick_chck);
-                // Check false negative-free correctness
-                auto error = ::std::get<0>(res);
-                if (unlikely(error)) {
-                    ::std::cout << "⎩ " << error << ::std::endl;
-                    return 1;
+        auto const nblibs = static_cast<size_t>(argc - argi - 1);
+        ::std::vector<::std::vector<double>> ticks(nblibs); // Median repetition duration of each library, for each thread count
+        ::std::string traced; // Summary of the recorded trace, printed with the next results
+        auto const runs = [&]() { // Thread count and open-loop arrival rate of each evaluation, 0 for closed loop
+            ::std::vector<::std::pair<size_t, double>> res;
+            for (auto nbthread: nbthreads) {
+                if (rates.empty())
+                    res.emplace_back(nbthread, 0.);
+                for (auto rate: rates)
+                    res.emplace_back(nbthread, rate);
+            }
+            return res;
+        }();
+        for (auto&& [nbthread, rate]: runs) {
+            auto const nbtxperthr = nbtx / nbthread;
+            auto const pertxdiv = static_cast<double>(nbthread) * static_cast<double>(nbtxperthr);
+            auto maxtick_init = Chrono::invalid_tick;
+            auto maxtick_perf = Chrono::invalid_tick;
+            auto maxtick_chck = Chrono::invalid_tick;
+            // Either one measurement of every repetition per library, or one round per repetition measuring every library
+            auto const nbrounds = interleave ? nbwarmups + nbrepeats : 1;
+            ::std::vector<Result> evals;
+            for (size_t i = 0; i < nblibs; ++i)
+                evals.push_back(Result{argv[argi + 1 + i], i == 0, nbthread, nbtxperthr, rate, nullptr, 0, {}, 0, {}, 1., NAN, NAN, {}, {}, {}, {}, {}, {}, {}, {}});
+            for (unsigned int round = 0; round < nbrounds; ++round) {
+                auto const warmups = interleave ? (round < nbwarmups ? 1 : 0) : nbwarmups;
+                auto const repeats = interleave ? (round < nbwarmups ? 0 : 1) : nbrepeats;
+                for (auto&& eval: evals) {
+                    auto const last = round + 1 == nbrounds; // Print the results after the last round
+                    if (last) {
+                        ::std::cout << "⎧ Evaluating '" << eval.path << "'" << (eval.reference ? " (reference)" : "");
+                        if (sweep)
+                            ::std::cout << " with " << nbthread << " worker thread(s)";
+                        if (rate > 0.)
+                            ::std::cout << " at " << rate << " TX/s";
+                        ::std::cout << "..." << ::std::endl;
+                    }
+                    // Load TM library
+                    TransactionalLibrary tl{eval.path};
+                    // Snapshot the memory usage before the shared memory exists
+                    ::std::optional<SharedLedger> ledger;
+                    ::std::optional<MemoryUsage> before;
+                    if (memory) {
+                        ledger.emplace();
+                        auto reset = MemoryUsage::reset_peak();
+                        before = MemoryUsage::take();
+                        if (!reset) // The peak would be the one of the whole process
+                            before->peak_rss.reset();
+                    }
+                    // Initialize workload (shared memory lifetime bound to workload: created and destroyed at the same time)
+                    auto const instance = make_workload(tl, nbthread, nbtxperthr);
+                    // Record one extra repetition of the reference, with the first thread count, before its first measured one
+                    ::std::optional<TraceRecording> recording;
+                    if (record && eval.reference && nbthread == nbthreads.front() && repeats > 0 && eval.ticks.empty())
+                        recording.emplace(nbthread, instance->get_tm().get_start(), instance->get_tm().get_size(), instance->get_tm().get_align());
+                    try {
+                        // Actual performance measurements and correctness check
+                        auto res = measure(*instance, nbthread, warmups, repeats, seed + nbthread * round, maxtick_init, maxtick_perf, maxtick_chck, cpus, counters, recording ? &*recording : nullptr, rate / static_cast<double>(nbthread), interval, ledger ? &*ledger : nullptr);
+                        // Check false negative-free correctness
+                        if (unlikely(res.error)) {
+                            if (!last)
+                                ::std::cout << "⎧ Evaluating '" << eval.path << "'..." << ::std::endl;
+                            ::std::cout << "⎩ " << res.error << ::std::endl;
+                            eval.error = res.error;
+                            results.push_back(::std::move(eval));
+                            emit();
+                            return 1;
+                        }
+                        if (recording) {
+                            auto bytes = recording->save(record);
+                            auto count = recording->count();
+                            traced = "'" + ::std::string{record} + "', " + ::std::to_string(count.first) + " TX in " + ::std::to_string(count.second) + " operations (" + ::std::to_string(bytes) + " bytes)";
+                        }
+                        // Accumulate results
+                        if (round == 0) {
+                            eval.tick_init = res.tick_init;
+                            eval.tick_chck = res.tick_chck;
+                        }
+                        auto const offset = eval.timeline.empty() ? Chrono::Tick{0} : eval.timeline.back().tick; // Rounds follow each other in the timeline
+                        for (auto&& sample: res.timeline)
+                            eval.timeline.push_back(Timeline::Sample{offset + sample.tick, sample.commits});
+                        for (auto start: res.starts)
+                            eval.starts.push_back(offset + start);
+                        if (before) {
+                            auto const after = MemoryUsage::take();
+                            Footprint footprint;
+                            if (before->peak_rss)
+                                footprint.peak_rss = after.peak_rss;
+                            footprint.base_rss = before->rss;
+                            footprint.minor_faults = after.minor_faults - before->minor_faults;
+                            footprint.major_faults = after.major_faults - before->major_faults;
+                            footprint.heap = static_cast<int_fast64_t>(after.heap) - static_cast<int_fast64_t>(before->heap);
+                            footprint.live = instance->get_tm().get_size() + ledger->get_live();
+                            if (round == 0) {
+                                eval.footprint = footprint;
+                            } else {
+                                eval.footprint.merge(footprint);
+                            }
+                        }
+                        eval.ticks.insert(eval.ticks.end(), res.ticks.begin(), res.ticks.end());
+                        eval.aborts.merge(res.aborts);
+                        eval.counters.merge(res.counters);
+                        if (!res.ticks.empty()) { // Warmup-only rounds never reset the statistics
+                            eval.latency.merge(res.latency);
+                            auto const& stats = instance->get_stats();
+                            for (size_t j = 0; j < stats.get_names().size(); ++j) {
+                                if (eval.stats.size() <= j)
+                                    eval.stats.emplace_back(stats.get_names()[j], Statistics::Entry{});
+                                eval.stats[j].second.merge(stats.merged(j));
+                            }
+                            auto const metrics = instance->get_metrics();
+                            auto const nbmerged = static_cast<double>(interleave ? eval.ticks.size() : 1); // Measured rounds so far
+                            for (size_t j = 0; j < metrics.size(); ++j) {
+                                if (eval.metrics.size() <= j)
+                                    eval.metrics.emplace_back(metrics[j].first, 0.);
+                                eval.metrics[j].second += (metrics[j].second - eval.metrics[j].second) / nbmerged;
+                            }
+                        }
+                        if (maxtick_init == Chrono::invalid_tick && !res.ticks.empty()) { // Set reference timeouts
+                            maxtick_init = slow_factor * res.tick_init;
+                            if (unlikely(maxtick_init == Chrono::invalid_tick)) // Bad luck...
+                                ++maxtick_init;
+                            maxtick_perf = slow_factor * *::std::max_element(res.ticks.begin(), res.ticks.end());
+                            if (unlikely(maxtick_perf == Chrono::invalid_tick)) // Bad luck...
+                                ++maxtick_perf;
+                            maxtick_chck = maxtick_perf; // The check is lighter than one repetition
+                        }
+                        if (!last)
+                            continue;
+                        // Print results
+                        eval.summary = summarize(eval.ticks);
+                        auto const& reference = evals[0];
+                        ::std::cout << "⎪ Median execution time: " << (eval.summary.median / 1000000.) << " ms";
+                        if (!eval.reference) { // Compare with reference performance
+                            eval.speedup = reference.summary.median / eval.summary.median;
+                            auto bounds = bootstrap_speedup(reference.ticks, eval.ticks, seed);
+                            eval.speedup_low = bounds.first;
+                            eval.speedup_high = bounds.second;
+                            ::std::cout << " -> " << eval.speedup << " speedup (95% CI " << eval.speedup_low << " - " << eval.speedup_high << ")";
+                        }
+                        ::std::cout << ::std::endl;
+                        ::std::cout << "⎪ Repetitions: trimmed mean " << (eval.summary.trimmed / 1000000.) << " ms, stddev " << (eval.summary.stddev / 1000000.) << " ms (" << eval.ticks.size() << " measured)" << ::std::endl;
+                        if (rate > 0.) {
+                            auto const& latency = eval.latency;
+                            ::std::cout << "⎪ Open loop: achieved " << (pertxdiv * 1000000000. / eval.summary.median) << " TX/s, latency from intended start p50 " << latency.percentile(50.) << " ns, p99 " << latency.percentile(99.) << " ns, p99.9 " << latency.percentile(99.9) << " ns, max " << latency.get_max() << " ns" << ::std::endl;
+                        }
+                        if (interval > 0)
+                            print_timeline(eval.timeline, interval);
+                        if (!traced.empty()) {
+                            ::std::cout << "⎪ Trace recorded: " << traced << ::std::endl;
+                            traced.clear();
+                        }
+                        print_aborts(eval.aborts);
+                        if (counters)
+                            print_counters(eval.counters, eval.aborts.total().commits);
+                        if (memory)
+                            print_footprint(eval.footprint);
+                        ::std::cout << (eval.stats.empty() && eval.metrics.empty() ? "⎩" : "⎪") << " Average TX execution time: " << (eval.summary.median / pertxdiv) << " ns" << ::std::endl;
+                        if (!eval.metrics.empty()) {
+                            ::std::cout << (eval.stats.empty() ? "⎩" : "⎪") << " Workload metrics: ";
+                            for (size_t j = 0; j < eval.metrics.size(); ++j)
+                                ::std::cout << (j > 0 ? ", " : "") << eval.metrics[j].first << " " << eval.metrics[j].second;
+                            ::std::cout << ::std::endl;
+                        }
+                        print_stats(eval.stats, "⎩ ");
+                    } catch (::std::exception const& err) { // Special case: cannot unload library with running threads, so print error and quick-exit
+                        ::std::cerr << "⎪ *** EXCEPTION ***" << ::std::endl;
+                        ::std::cerr << "⎩ " << err.what() << ::std::endl;
+                        ::std::quick_exit(2);
+                    }
                 }
-                // Print results
-                auto tick_init = ::std::get<1>(res);
-                auto tick_perf = ::std::get<2>(res);
-                auto tick_chck = ::std::get<3>(res);
-                auto perfdbl = static_cast<double>(tick_perf);
-                ::std::cout << "⎪ Total user execution time: " << (perfdbl / 1000000.) << " ms";
-                if (maxtick_init == Chrono::invalid_tick) { // Set reference performance
-                    maxtick_init = slow_factor * tick_init;
-                    if (unlikely(maxtick_init == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_init;
-                    maxtick_perf = slow_factor * tick_perf;
-                    if (unlikely(maxtick_perf == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_perf;
-                    maxtick_chck = slow_factor * tick_chck;
-                    if (unlikely(maxtick_chck == Chrono::invalid_tick)) // Bad luck...
-                        ++maxtick_chck;
-                    reference = perfdbl;
-                } else { // Compare with reference performance
-                    ::std::cout << " -> " << (reference / perfdbl) << " speedup";
+            }
+            for (size_t i = 0; i < nblibs; ++i) {
+                ticks[i].push_back(evals[i].summary.median);
+                results.push_back(::std::move(evals[i]));
+            }
+        }
+        // Scaling tables
+        if (sweep) {
+            for (size_t i = 0; i < nblibs; ++i)
+                print_scaling(argv[argi + 1 + i], nbthreads, ticks[i], nbtx);
+        }
+        // Latency versus throughput tables
+        if (!rates.empty()) {
+            for (size_t i = 0; i < nblibs; ++i) {
+                ::std::vector<Result const*> swept;
+                for (auto&& res: results) {
+                    if (res.path == argv[argi + 1 + i])
+                        swept.push_back(&res);
                 }
-                ::std::cout << ::std::endl;
-                ::std::cout << "⎩ Average TX execution time: " << (perfdbl / pertxdiv) << " ns" << ::std::endl;
-            } catch (::std::exception const& err) { // Special case: cannot unload library with running threads, so print error and quick-exit
-                ::std::cerr << "⎪ *** EXCEPTION ***" << ::std::endl;
-                ::std::cerr << "⎩ " << err.what() << ::std::endl;
-                ::std::quick_exit(2);
+                print_open_loop(argv[argi + 1 + i], swept);
             }
         }
+        emit();
         return 0;
     } catch (::std::exception const& err) {
         ::std::cerr << "⎧ *** EXCEPTION ***" << ::std::endl;
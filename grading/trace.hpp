@@ -0,0 +1,465 @@
+/**
+ * @file   trace.hpp
+ * @author Sébastien Rouault <sebastien.rouault@epfl.ch>
+ *
+ * @section LICENSE
+ *
+ * Copyright © 2018-2019 Sébastien Rouault.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * any later version. Please see https://gnu.org/licenses/gpl.html
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * @section DESCRIPTION
+ *
+ * Recording and loading of the transactional operations issued by each thread.
+**/
+
+#pragma once
+
+// External headers
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Internal headers
+#include "common.hpp"
+
+// -------------------------------------------------------------------------- //
+namespace Exception {
+
+/** Exception tree.
+**/
+EXCEPTION(Trace, Any, "trace exception");
+    EXCEPTION(TraceOpen, Trace, "unable to open or map the trace file");
+    EXCEPTION(TraceSave, Trace, "unable to write the trace file");
+    EXCEPTION(TraceFormat, Trace, "malformed trace file");
+
+}
+// -------------------------------------------------------------------------- //
+
+/** One traced operation, or run of consecutive accesses of the same size, as stored in the trace file.
+**/
+struct TraceOp {
+    /** Operation kind.
+    **/
+    enum Kind: uint8_t {
+        begin_rw,
+        begin_ro,
+        read,
+        write,
+        alloc,
+        free,
+        end
+    };
+    /** Memory segment the operation targets.
+    **/
+    enum Space: uint8_t {
+        start,  // First segment, 'offset' from its start address
+        own,    // Segment allocated by the same thread, 'offset' is its handle in the upper 32 bits and the offset in the lower ones
+        foreign // Any other segment, 'offset' in the folded granules placed after the first segment
+    };
+    uint8_t  kind;   // Operation kind
+    uint8_t  space;  // Memory segment targeted
+    uint16_t count;  // Number of consecutive accesses of 'size' bytes, 1 for the other kinds
+    uint32_t size;   // Size of each access, or of the allocation (in bytes)
+    uint64_t offset; // Location of the first access or freed segment, or handle of the allocated segment
+};
+static_assert(sizeof(TraceOp) == 16, "Unexpected padding in the trace operation layout");
+
+/** Trace file header.
+**/
+struct TraceHeader {
+    char     magic[8];  // Null-terminated 'magic_trace'
+    uint64_t nbthreads; // Number of recorded threads, i.e. of operation streams
+    uint64_t size;      // Size of the first segment of the recorded shared memory region (in bytes)
+    uint64_t align;     // Alignment of the recorded shared memory region (in bytes)
+    uint64_t folded;    // Size of the folded granules of the other segments (in bytes)
+};
+static_assert(sizeof(TraceHeader) % alignof(TraceOp) == 0, "Trace operations would be misaligned in the trace file");
+
+// Trace file identifier, with the layout version in the last character
+constexpr static char magic_trace[8] = "TMTRAC1";
+
+/** Dense numbering of the granules of the segments not attributable to one thread, shared by the recorders.
+**/
+class TraceFolding final: private NonCopyable {
+private:
+    size_t granule; // Size of a granule (in bytes)
+    ::std::mutex lock; // Protects 'indices'
+    ::std::unordered_map<uintptr_t, uint64_t> indices; // Index of each granule seen so far, by address divided by 'granule'
+public:
+    /** Granularity constructor.
+     * @param granule Size of a granule (in bytes)
+    **/
+    TraceFolding(size_t granule): granule{granule} {}
+public:
+    /** [thread-safe] Fold an address, numbering its granule on first use.
+     * @param addr Address to fold
+     * @return Offset in the folded granules
+    **/
+    uint64_t fold(uintptr_t addr) {
+        ::std::unique_lock<decltype(lock)> guard{lock};
+        auto index = indices.emplace(addr / granule, indices.size()).first->second;
+        return index * granule + addr % granule;
+    }
+    /** Get the size of every granule folded so far.
+     * @return Size of the folded granules (in bytes)
+    **/
+    size_t get_size() const noexcept {
+        return indices.size() * granule;
+    }
+};
+
+/** Per-thread recorder of the committed transactions.
+**/
+class TraceRecorder final {
+private:
+    TraceFolding* folding; // Numbering of the granules of the other segments
+    uintptr_t start;      // Start address of the first segment
+    size_t    start_size; // Size of the first segment (in bytes)
+    ::std::vector<TraceOp> ops; // Operations of the committed transactions, then of the pending one
+    size_t    pending;    // Index of the begin operation of the pending transaction
+    ::std::map<uintptr_t, ::std::pair<uint32_t, size_t>> owned; // Handle and size of each segment allocated and not freed by this thread, by start address
+    ::std::vector<uintptr_t> allocated; // Segments allocated by the pending transaction
+    ::std::vector<uintptr_t> freed;     // Segments freed by the pending transaction
+    uint32_t  nbhandles;  // Number of segments allocated by the committed transactions
+    size_t    nbtxs;      // Number of committed transactions
+public:
+    /** First segment constructor.
+     * @param folding Numbering of the granules of the other segments
+     * @param start   Start address of the first segment
+     * @param size    Size of the first segment (in bytes)
+    **/
+    TraceRecorder(TraceFolding& folding, void* start, size_t size): folding{&folding}, start{reinterpret_cast<uintptr_t>(start)}, start_size{size}, pending{0}, nbhandles{0}, nbtxs{0} {}
+private:
+    /** Locate an address in the recorded shared memory region.
+     * @param addr Address to locate
+     * @return Memory segment and offset, as stored in the trace
+    **/
+    ::std::pair<TraceOp::Space, uint64_t> locate(uintptr_t addr) {
+        if (addr - start < start_size)
+            return {TraceOp::start, addr - start};
+        auto it = owned.upper_bound(addr);
+        if (it != owned.begin()) {
+            --it;
+            if (addr - it->first < it->second.second)
+                return {TraceOp::own, (static_cast<uint64_t>(it->second.first) << 32) | (addr - it->first)};
+        }
+        return {TraceOp::foreign, folding->fold(addr)};
+    }
+public:
+    /** Record the beginning of a transaction.
+     * @param ro Whether the transaction is read-only
+    **/
+    void begin(bool ro) {
+        pending = ops.size();
+        ops.push_back(TraceOp{ro ? TraceOp::begin_ro : TraceOp::begin_rw, TraceOp::start, 1, 0, 0});
+    }
+    /** Record a successful access, merged with the previous one when they are contiguous.
+     * @param kind   Either 'TraceOp::read' or 'TraceOp::write'
+     * @param target Accessed address in shared memory
+     * @param size   Accessed size (in bytes)
+    **/
+    void access(TraceOp::Kind kind, void const* target, size_t size) {
+        auto location = locate(reinterpret_cast<uintptr_t>(target));
+        if (ops.size() > pending + 1) {
+            auto&& last = ops.back();
+            if (last.kind == kind && last.space == location.first && last.size == size && last.count < UINT16_MAX && last.offset + last.count * size == location.second) {
+                ++last.count;
+                return;
+            }
+        }
+        ops.push_back(TraceOp{kind, location.first, 1, static_cast<uint32_t>(size), location.second});
+    }
+    /** Record a successful allocation.
+     * @param target Start address of the allocated segment
+     * @param size   Size of the allocated segment (in bytes)
+    **/
+    void alloc(void* target, size_t size) {
+        auto handle = static_cast<uint32_t>(nbhandles + allocated.size());
+        owned[reinterpret_cast<uintptr_t>(target)] = {handle, size};
+        allocated.push_back(reinterpret_cast<uintptr_t>(target));
+        ops.push_back(TraceOp{TraceOp::alloc, TraceOp::own, 1, static_cast<uint32_t>(size), handle});
+    }
+    /** Record a successful freeing.
+     * @param target Start address of the freed segment
+    **/
+    void free(void* target) {
+        auto location = locate(reinterpret_cast<uintptr_t>(target));
+        freed.push_back(reinterpret_cast<uintptr_t>(target));
+        ops.push_back(TraceOp{TraceOp::free, location.first, 1, 0, location.second});
+    }
+    /** Record the commit of the pending transaction.
+    **/
+    void commit() {
+        ops.push_back(TraceOp{TraceOp::end, TraceOp::start, 1, 0, 0});
+        for (auto addr: freed)
+            owned.erase(addr);
+        nbhandles += allocated.size();
+        allocated.clear();
+        freed.clear();
+        pending = ops.size();
+        ++nbtxs;
+    }
+    /** Discard the pending transaction, which aborted.
+    **/
+    void rollback() {
+        ops.resize(pending);
+        for (auto addr: allocated)
+            owned.erase(addr);
+        allocated.clear();
+        freed.clear();
+    }
+public:
+    /** Get the operations of the committed transactions.
+     * @return Operations, the pending transaction (if any) excluded
+    **/
+    auto get_ops() const noexcept {
+        return ::std::make_pair(ops.data(), pending);
+    }
+    /** Get the number of committed transactions.
+     * @return Number of committed transactions
+    **/
+    auto get_nbtxs() const noexcept {
+        return nbtxs;
+    }
+};
+
+/** Recording of every thread over one shared memory region.
+**/
+class TraceRecording final: private NonCopyable {
+private:
+    size_t size;  // Size of the first segment (in bytes)
+    size_t align; // Alignment of the shared memory region (in bytes)
+    TraceFolding folding; // Numbering of the granules of the segments allocated before the recording or by other threads
+    ::std::vector<TraceRecorder> recorders; // Recorder of each thread
+public:
+    /** Shared memory region constructor.
+     * @param nbthreads Number of threads to record
+     * @param start     Start address of the first segment
+     * @param size      Size of the first segment (in bytes)
+     * @param align     Alignment of the shared memory region (in bytes)
+    **/
+    TraceRecording(size_t nbthreads, void* start, size_t size, size_t align): size{size}, align{align}, folding{::std::max<size_t>(64, align)} { // Cache line granules, as conflicts are usually detected at that granularity or a finer one
+        recorders.reserve(nbthreads);
+        for (size_t i = 0; i < nbthreads; ++i)
+            recorders.emplace_back(folding, start, size);
+    }
+public:
+    /** [thread-safe] Get the recorder of one thread.
+     * @param i Index of the thread
+     * @return Recorder only used by the given thread
+    **/
+    auto& get(size_t i) noexcept {
+        return recorders[i];
+    }
+    /** Count the committed transactions and the operations recorded.
+     * @return Number of transactions and of operations, over every thread
+    **/
+    auto count() const noexcept {
+        ::std::pair<size_t, size_t> res{0, 0};
+        for (auto&& recorder: recorders) {
+            res.first += recorder.get_nbtxs();
+            res.second += recorder.get_ops().second;
+        }
+        return res;
+    }
+    /** Write the recorded operations to a trace file, through a shared mapping.
+     * @param path Path of the trace file, truncated if it exists
+     * @return Size of the trace file (in bytes)
+    **/
+    size_t save(char const* path) const {
+        auto total = sizeof(TraceHeader) + recorders.size() * sizeof(uint64_t) + count().second * sizeof(TraceOp);
+        auto fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (unlikely(fd < 0))
+            throw Exception::TraceSave{};
+        if (unlikely(::ftruncate(fd, static_cast<off_t>(total)) != 0)) {
+            ::close(fd);
+            throw Exception::TraceSave{};
+        }
+        auto map = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (unlikely(map == MAP_FAILED))
+            throw Exception::TraceSave{};
+        auto cursor = reinterpret_cast<uint8_t*>(map);
+        TraceHeader header{{}, recorders.size(), size, align, folding.get_size()};
+        ::std::memcpy(header.magic, magic_trace, sizeof(magic_trace));
+        ::std::memcpy(cursor, &header, sizeof(header));
+        cursor += sizeof(header);
+        for (auto&& recorder: recorders) {
+            uint64_t nbops = recorder.get_ops().second;
+            ::std::memcpy(cursor, &nbops, sizeof(nbops));
+            cursor += sizeof(nbops);
+        }
+        for (auto&& recorder: recorders) {
+            auto ops = recorder.get_ops();
+            ::std::memcpy(cursor, ops.first, ops.second * sizeof(TraceOp));
+            cursor += ops.second * sizeof(TraceOp);
+        }
+        auto synced = ::msync(map, total, MS_SYNC) == 0;
+        ::munmap(map, total);
+        if (unlikely(!synced))
+            throw Exception::TraceSave{};
+        return total;
+    }
+};
+
+/** Read-only mapping of a trace file.
+**/
+class TraceFile final: private NonCopyable {
+private:
+    void*  map;   // Mapped trace file
+    size_t total; // Size of the mapping (in bytes)
+    TraceHeader header; // Copy of the trace file header
+    ::std::vector<::std::pair<TraceOp const*, size_t>> streams; // First operation and number of operations of each recorded thread
+public:
+    /** Mapping constructor, validating every stream of operations.
+     * @param path Path of the trace file
+    **/
+    TraceFile(char const* path) {
+        auto fd = ::open(path, O_RDONLY);
+        if (unlikely(fd < 0))
+            throw Exception::TraceOpen{};
+        struct ::stat info;
+        if (unlikely(::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(TraceHeader))) {
+            ::close(fd);
+            throw Exception::TraceFormat{};
+        }
+        total = static_cast<size_t>(info.st_size);
+        map = ::mmap(nullptr, total, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (unlikely(map == MAP_FAILED))
+            throw Exception::TraceOpen{};
+        try {
+            ::std::memcpy(&header, map, sizeof(header));
+            if (unlikely(::std::memcmp(header.magic, magic_trace, sizeof(magic_trace)) != 0 || header.nbthreads == 0 || header.size == 0 || header.align == 0 || (header.align & (header.align - 1)) != 0 || header.size % header.align != 0 || header.folded % header.align != 0))
+                throw Exception::TraceFormat{};
+            auto const counts = reinterpret_cast<uint64_t const*>(reinterpret_cast<uint8_t const*>(map) + sizeof(header));
+            if (unlikely((total - sizeof(header)) / sizeof(uint64_t) < header.nbthreads))
+                throw Exception::TraceFormat{};
+            auto ops = reinterpret_cast<TraceOp const*>(counts + header.nbthreads);
+            auto left = (total - sizeof(header) - header.nbthreads * sizeof(uint64_t)) / sizeof(TraceOp);
+            for (size_t i = 0; i < header.nbthreads; ++i) {
+                if (unlikely(counts[i] > left))
+                    throw Exception::TraceFormat{};
+                validate(header, ops, counts[i]);
+                streams.emplace_back(ops, counts[i]);
+                ops += counts[i];
+                left -= counts[i];
+            }
+        } catch (...) {
+            ::munmap(map, total);
+            throw;
+        }
+    }
+    /** Unmapping destructor.
+    **/
+    ~TraceFile() noexcept {
+        ::munmap(map, total);
+    }
+private:
+    /** Check that a stream is a sequence of complete transactions, with aligned accesses within the first segment or the
+     * segments allocated before by the same stream, and aligned allocations numbered in order, so that replaying it never
+     * goes out of bounds (the accesses to the other segments are wrapped within the folded granules when replaying).
+     * @param header Header of the trace file
+     * @param ops    First operation of the stream
+     * @param nbops  Number of operations of the stream
+    **/
+    static void validate(TraceHeader const& header, TraceOp const* ops, size_t nbops) {
+        auto intx = false;
+        ::std::vector<uint64_t> sizes; // Size of each segment allocated so far, by handle
+        for (size_t i = 0; i < nbops; ++i) {
+            auto const& op = ops[i];
+            auto begin = op.kind == TraceOp::begin_rw || op.kind == TraceOp::begin_ro;
+            if (unlikely(op.kind > TraceOp::end || begin == intx || op.count == 0 || op.space > TraceOp::foreign))
+                throw Exception::TraceFormat{};
+            switch (op.kind) {
+            case TraceOp::read:
+            case TraceOp::write: {
+                auto offset = op.space == TraceOp::own ? op.offset & UINT32_MAX : op.offset;
+                auto limit = op.space == TraceOp::start ? header.size : UINT64_MAX; // Bytes the access may span from the segment start
+                if (op.space == TraceOp::own) {
+                    auto handle = op.offset >> 32;
+                    if (unlikely(handle >= sizes.size()))
+                        throw Exception::TraceFormat{};
+                    limit = sizes[handle];
+                }
+                auto span = static_cast<uint64_t>(op.size) * op.count;
+                if (unlikely(op.size == 0 || op.size % header.align != 0 || offset % header.align != 0 || offset > limit || span > limit - offset))
+                    throw Exception::TraceFormat{};
+            } break;
+            case TraceOp::alloc:
+                if (unlikely(op.space != TraceOp::own || op.offset != sizes.size() || op.size == 0 || op.size % header.align != 0))
+                    throw Exception::TraceFormat{};
+                sizes.push_back(op.size);
+                break;
+            default:
+                break;
+            }
+            if (begin || op.kind == TraceOp::end)
+                intx = begin;
+        }
+        if (unlikely(intx))
+            throw Exception::TraceFormat{};
+    }
+public:
+    /** Get the number of recorded threads.
+     * @return Number of operation streams
+    **/
+    size_t get_nbthreads() const noexcept {
+        return header.nbthreads;
+    }
+    /** Get the size of the first segment of the recorded shared memory region.
+     * @return Size of the first segment (in bytes)
+    **/
+    size_t get_size() const noexcept {
+        return header.size;
+    }
+    /** Get the size of the folded granules of the other segments, placed after the first segment when replaying.
+     * @return Size of the folded granules (in bytes)
+    **/
+    size_t get_folded() const noexcept {
+        return header.folded;
+    }
+    /** Get the alignment of the recorded shared memory region.
+     * @return Alignment (in bytes)
+    **/
+    size_t get_align() const noexcept {
+        return header.align;
+    }
+    /** [thread-safe] Get the operations recorded by one thread.
+     * @param i Index of the recorded thread
+     * @return First operation and number of operations
+    **/
+    auto const& get_stream(size_t i) const noexcept {
+        return streams[i];
+    }
+    /** Count the recorded transactions.
+     * @return Number of transactions, over every thread
+    **/
+    size_t count() const noexcept {
+        size_t res = 0;
+        for (auto&& stream: streams) {
+            for (size_t i = 0; i < stream.second; ++i)
+                res += stream.first[i].kind == TraceOp::end ? 1 : 0;
+        }
+        return res;
+    }
+};
@@ -28,12 +28,20 @@ extern "C" {
 #include <dlfcn.h>
 #include <limits.h>
 }
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 // Internal headers
 namespace STM {
 #include <tm.hpp>
 }
 #include "common.hpp"
+#include "trace.hpp"
 
 // -------------------------------------------------------------------------- //
 namespace Exception {
@@ -259,6 +267,55 @@ public:
     }
 };
 
+// Recorder of the committed transactions of the calling thread, 'nullptr' for none
+static thread_local TraceRecorder* transactional_trace = nullptr;
+
+/** Live shared memory accounting class, from the allocations and freeings of the committed transactions.
+**/
+class SharedLedger final: private NonCopyable {
+private:
+    ::std::mutex lock; // Protects the fields below
+    ::std::unordered_map<void*, size_t> sizes; // Size of each live allocated segment, by start address
+    size_t live; // Total size of the live allocated segments (in bytes)
+public:
+    /** Empty constructor.
+    **/
+    SharedLedger(): live{0} {}
+public:
+    /** [thread-safe] Account for the segments allocated and freed by a committed transaction.
+     * @param allocated Start address and size of each allocated segment
+     * @param freed     Start address of each freed segment
+    **/
+    void commit(::std::vector<::std::pair<void*, size_t>> const& allocated, ::std::vector<void*> const& freed) {
+        ::std::unique_lock<decltype(lock)> guard{lock};
+        for (auto&& segment: allocated) {
+            auto&& size = sizes[segment.first];
+            live += segment.second - size;
+            size = segment.second;
+        }
+        for (auto target: freed) {
+            auto it = sizes.find(target);
+            if (it == sizes.end()) // Allocated before the ledger was attached
+                continue;
+            live -= it->second;
+            sizes.erase(it);
+        }
+    }
+    /** [thread-safe] Get the total size of the live allocated segments.
+     * @return Live allocated bytes, the first segment excluded
+    **/
+    size_t get_live() {
+        ::std::unique_lock<decltype(lock)> guard{lock};
+        return live;
+    }
+};
+
+// Live shared memory accounting of the calling thread, 'nullptr' for none
+static thread_local SharedLedger* transactional_ledger = nullptr;
+
+// Number of committed transactions of the calling thread, only written by that thread but read concurrently, 'nullptr' for none
+static thread_local ::std::atomic<uint_fast64_t>* transactional_commits = nullptr;
+
 /** One transaction over a shared memory region management class.
 **/
 class Transaction final: private NonCopyable {
@@ -269,11 +326,33 @@ public:
         read_write = false,
         read_only  = true
     };
+    /** Transactional operation class.
+    **/
+    enum class Op: size_t {
+        read,
+        write,
+        alloc,
+        free,
+        end,
+        count // Number of operations
+    };
+    /** Aborted attempt class.
+    **/
+    struct Abort {
+        Op     op;    // Operation that failed
+        size_t nbops; // Number of operations that succeeded before
+    };
 private:
     TransactionalMemory const& tm; // Bound transactional memory
     STM::tx_t tx; // Opaque transaction handle
     bool aborted; // Transaction was aborted
     bool is_ro;   // Whether the transaction is read-only (solely for assertion)
+    size_t nbops; // Number of operations that succeeded so far
+    ::std::vector<::std::pair<void*, size_t>> allocated; // Segments allocated so far, only with a ledger
+    ::std::vector<void*> freed; // Segments freed so far, only with a ledger
+public:
+    // Last attempt aborted by the calling thread
+    static inline thread_local Abort last_abort;
 public:
     /** Deleted copy constructor/assignment.
     **/
@@ -283,18 +362,41 @@ public:
      * @param tm Transactional memory to bind
      * @param ro Whether the transaction is read-only
     **/
-    Transaction(TransactionalMemory const& tm, Mode ro): tm{tm}, tx{tm.begin(static_cast<bool>(ro))}, aborted{false}, is_ro{static_cast<bool>(ro)} {
+    Transaction(TransactionalMemory const& tm, Mode ro): tm{tm}, tx{tm.begin(static_cast<bool>(ro))}, aborted{false}, is_ro{static_cast<bool>(ro)}, nbops{0} {
         if (unlikely(tx == STM::invalid_tx))
             throw Exception::TransactionBegin{};
+        if (unlikely(transactional_trace))
+            transactional_trace->begin(is_ro);
     }
     /** End destructor.
     **/
     ~Transaction() noexcept(false) {
         if (likely(!aborted)) {
-            if (unlikely(!tm.end(tx)))
+            if (unlikely(!tm.end(tx))) {
+                if (unlikely(transactional_trace))
+                    transactional_trace->rollback();
+                last_abort = Abort{Op::end, nbops};
                 throw Exception::TransactionRetry{};
+            }
+            if (unlikely(transactional_trace))
+                transactional_trace->commit();
+            if (unlikely(transactional_ledger) && (!allocated.empty() || !freed.empty()))
+                transactional_ledger->commit(allocated, freed);
+            if (transactional_commits) // Single writer, no need for an atomic read-modify-write
+                transactional_commits->store(transactional_commits->load(::std::memory_order_relaxed) + 1, ::std::memory_order_relaxed);
+        } else if (unlikely(transactional_trace)) {
+            transactional_trace->rollback();
         }
     }
+private:
+    /** Account for an operation that failed, the transaction has aborted.
+     * @param op Operation that failed
+    **/
+    [[noreturn]] void retry(Op op) {
+        aborted = true;
+        last_abort = Abort{op, nbops};
+        throw Exception::TransactionRetry{};
+    }
 public:
     /** [thread-safe] Return the bound transactional memory instance.
      * @return Bound transactional memory instance
@@ -309,10 +411,11 @@ public:
      * @param target Target start address
     **/
     void read(void const* source, size_t size, void* target) {
-        if (unlikely(!tm.read(tx, source, size, target))) {
-            aborted = true;
-            throw Exception::TransactionRetry{};
-        }
+        if (unlikely(!tm.read(tx, source, size, target)))
+            retry(Op::read);
+        if (unlikely(transactional_trace))
+            transactional_trace->access(TraceOp::read, source, size);
+        ++nbops;
     }
     /** [thread-safe] Write operation in the bound transaction, source in a private region and target in the shared region.
      * @param source Source start address
@@ -322,10 +425,11 @@ public:
     void write(void const* source, size_t size, void* target) {
         if (unlikely(assert_mode && is_ro))
             throw Exception::TransactionReadOnly{};
-        if (unlikely(!tm.write(tx, source, size, target))) {
-            aborted = true;
-            throw Exception::TransactionRetry{};
-        }
+        if (unlikely(!tm.write(tx, source, size, target)))
+            retry(Op::write);
+        if (unlikely(transactional_trace))
+            transactional_trace->access(TraceOp::write, target, size);
+        ++nbops;
     }
     /** [thread-safe] Memory allocation operation in the bound transaction, throw if no memory available.
      * @param size Size to allocate
@@ -337,12 +441,16 @@ public:
         void* target;
         switch (tm.alloc(tx, size, &target)) {
         case STM::Alloc::success:
+            if (unlikely(transactional_trace))
+                transactional_trace->alloc(target, size);
+            if (unlikely(transactional_ledger))
+                allocated.emplace_back(target, size);
+            ++nbops;
             return target;
         case STM::Alloc::nomem:
             throw Exception::TransactionAlloc{};
         default: // STM::Alloc::abort
-            aborted = true;
-            throw Exception::TransactionRetry{};
+            retry(Op::alloc);
         }
     }
     /** [thread-safe] Memory freeing operation in the bound transaction.
@@ -351,10 +459,13 @@ public:
     void free(void* target) {
         if (unlikely(assert_mode && is_ro))
             throw Exception::TransactionReadOnly{};
-        if (unlikely(!tm.free(tx, target))) {
-            aborted = true;
-            throw Exception::TransactionRetry{};
-        }
+        if (unlikely(!tm.free(tx, target)))
+            retry(Op::free);
+        if (unlikely(transactional_trace))
+            transactional_trace->free(target);
+        if (unlikely(transactional_ledger))
+            freed.push_back(target);
+        ++nbops;
     }
 };
 
@@ -521,7 +632,7 @@ public:
      * @param source Private content to write at the shared address
     **/
     void write(size_t index, Type const& source) const {
-        tx.write(tx, &source, sizeof(Type), address + index);
+        tx.write(&source, sizeof(Type), address + index);
     }
 public:
     /** Reference a cell.
@@ -580,7 +691,7 @@ public:
     void write(size_t index, Type const& source) const {
         if (unlikely(assert_mode && index >= n))
             throw Exception::SharedOverflow{};
-        tx.write(tx, &source, sizeof(Type), address + index);
+        tx.write(&source, sizeof(Type), address + index);
     }
 public:
     /** Reference a cell.
@@ -602,18 +713,240 @@ public:
 
 // -------------------------------------------------------------------------- //
 
+/** Per call site accounting of the aborted attempts class.
+**/
+class Aborts final {
+public:
+    /** Accounting of one call site class.
+    **/
+    class Site final {
+    public:
+        char const*   name;    // Name of the function calling 'transactional'
+        uint_fast64_t commits; // Number of committed transactions
+        uint_fast64_t aborts[static_cast<size_t>(Transaction::Op::count)]; // Number of aborted attempts, per failed operation
+        Chrono::Tick  wasted_tick; // Time spent in aborted attempts (in ns)
+        uint_fast64_t wasted_ops;  // Number of operations that succeeded in aborted attempts
+    public:
+        /** Name constructor.
+         * @param name Name of the call site
+        **/
+        Site(char const* name) noexcept: name{name}, commits{0}, aborts{}, wasted_tick{0}, wasted_ops{0} {}
+    public:
+        /** Get the total number of aborted attempts.
+         * @return Number of aborted attempts
+        **/
+        auto get_aborts() const noexcept {
+            uint_fast64_t res = 0;
+            for (auto count: aborts)
+                res += count;
+            return res;
+        }
+        /** Add the accounting of another site.
+         * @param other Site to merge
+        **/
+        void merge(Site const& other) noexcept {
+            commits += other.commits;
+            for (size_t i = 0; i < static_cast<size_t>(Transaction::Op::count); ++i)
+                aborts[i] += other.aborts[i];
+            wasted_tick += other.wasted_tick;
+            wasted_ops += other.wasted_ops;
+        }
+    };
+    /** Scope guard counting a committed transaction of a call site, i.e. if no exception leaves the scope.
+    **/
+    class Commit final: private NonCopyable {
+    private:
+        Site* site;       // Call site to count into, 'nullptr' for none
+        int   exceptions; // Number of uncaught exceptions when entering the scope
+    public:
+        /** Call site constructor.
+         * @param site Call site to count into, 'nullptr' for none
+        **/
+        Commit(Site* site) noexcept: site{site}, exceptions{::std::uncaught_exceptions()} {}
+        /** Counting destructor.
+        **/
+        ~Commit() noexcept {
+            if (site && ::std::uncaught_exceptions() == exceptions)
+                ++site->commits;
+        }
+    };
+private:
+    ::std::deque<Site> sites; // Accounting of every call site seen so far, in a container whose elements never move
+public:
+    /** Get the accounting of a call site, created on first use; only used by the thread owning this instance.
+     * @param name Name of the call site
+     * @return Accounting of the call site, which remains valid while new call sites are added
+    **/
+    Site& get(char const* name) {
+        for (auto&& site: sites) {
+            if (site.name == name || ::std::strcmp(site.name, name) == 0)
+                return site;
+        }
+        sites.emplace_back(name);
+        return sites.back();
+    }
+    /** Add the accounting of every call site of another instance.
+     * @param other Accounting to merge
+    **/
+    void merge(Aborts const& other) {
+        for (auto&& site: other.sites)
+            get(site.name).merge(site);
+    }
+    /** Get the accounting of every call site.
+     * @return Accounting of every call site, in order of first use
+    **/
+    auto const& get_sites() const noexcept {
+        return sites;
+    }
+    /** Sum the accounting of every call site.
+     * @return Total accounting
+    **/
+    Site total() const noexcept {
+        Site res{"total"};
+        for (auto&& site: sites)
+            res.merge(site);
+        return res;
+    }
+};
+
+/** Open-loop arrival schedule of one thread class, the transactions arriving as a Poisson process.
+**/
+class Arrivals final {
+public:
+    /** Scope guard recording the latency of a transaction if it commits, i.e. if no exception leaves the scope.
+    **/
+    class Departure final: private NonCopyable {
+    private:
+        Arrivals*    arrivals;   // Schedule to record into, 'nullptr' for none
+        Chrono::Tick intended;   // Intended start of the transaction
+        int          exceptions; // Number of uncaught exceptions when entering the scope
+    public:
+        /** Arrival constructor.
+         * @param arrivals Schedule to record into, 'nullptr' for none
+         * @param intended Intended start of the transaction
+        **/
+        Departure(Arrivals* arrivals, Chrono::Tick intended) noexcept: arrivals{arrivals}, intended{intended}, exceptions{::std::uncaught_exceptions()} {}
+        /** Recording destructor.
+        **/
+        ~Departure() noexcept {
+            if (arrivals && ::std::uncaught_exceptions() == exceptions)
+                arrivals->depart(intended);
+        }
+    };
+private:
+    ::std::minstd_rand engine; // Arrival generator
+    ::std::exponential_distribution<double> gap; // Time between two consecutive arrivals (in ns)
+    Chrono    clock; // Started at the beginning of the schedule
+    double    next;  // Intended start of the transaction after the pending one, since the beginning of the schedule (in ns)
+    Chrono::Tick pending; // Intended start of the transaction already waited for, since the beginning of the schedule (in ns)
+    bool      paced; // Whether 'pending' was waited for and not yet consumed by 'arrive'
+    Histogram latency; // Latency of the committed transactions, from their intended start (in ns)
+public:
+    /** Rate constructor.
+     * @param rate Mean number of arrivals per second
+    **/
+    Arrivals(double rate): gap{rate / 1000000000.}, next{0.}, pending{0}, paced{false} {}
+public:
+    /** Start the schedule over from now.
+     * @param seed Seed of the arrivals
+    **/
+    void restart(::std::minstd_rand::result_type seed) {
+        engine.seed(seed);
+        clock.start();
+        next = gap(engine);
+        paced = false;
+    }
+    /** Wait for the intended start of the next transaction, right away if late, unless already waited for.
+    **/
+    void pace() {
+        if (paced)
+            return;
+        while (true) {
+            auto left = next - static_cast<double>(clock.delta());
+            if (left <= 0.)
+                break;
+            if (left > 100000.) { // Sleep through most of a long wait
+                ::std::this_thread::sleep_for(::std::chrono::nanoseconds{static_cast<long>(left) - 50000});
+            } else {
+                short_pause();
+            }
+        }
+        pending = static_cast<Chrono::Tick>(next);
+        next += gap(engine);
+        paced = true;
+    }
+    /** Consume the intended start of the next transaction, waiting for it if 'pace' was not called.
+     * @return Intended start, since the beginning of the schedule (in ns)
+    **/
+    Chrono::Tick arrive() {
+        pace();
+        paced = false;
+        return pending;
+    }
+    /** Record the commit of a transaction.
+     * @param intended Intended start of the transaction, since the beginning of the schedule
+    **/
+    void depart(Chrono::Tick intended) noexcept {
+        latency.record(clock.delta() - intended);
+    }
+    /** Clear the recorded latencies, e.g. after warmup repetitions.
+    **/
+    void reset() noexcept {
+        latency = Histogram{};
+    }
+    /** Get the recorded latencies.
+     * @return Latency of the committed transactions, from their intended start (in ns)
+    **/
+    auto const& get_latency() const noexcept {
+        return latency;
+    }
+};
+
+// Number of retries of the last transaction committed through 'transactional' by the calling thread
+static thread_local size_t transactional_retries = 0;
+
+// Abort accounting of the calling thread, 'nullptr' for none
+static thread_local Aborts* transactional_aborts = nullptr;
+
+// Open-loop schedule of the calling thread, 'nullptr' for closed loop
+static thread_local Arrivals* transactional_arrivals = nullptr;
+
+/** Wait for the intended start of the next transaction of the calling thread when in open loop, to call before timing it.
+**/
+static void transactional_pace() {
+    if (transactional_arrivals)
+        transactional_arrivals->pace();
+}
+
 /** Repeat a given transaction until it commits.
  * @param tm   Transactional memory
  * @param mode Transactional mode
  * @param func Transaction closure (Transaction& -> ...)
+ * @param site Name of the call site (optional, defaults to the calling function)
  * @return Returned value (or void) when the transaction committed
 **/
-template<class Func> static auto transactional(TransactionalMemory const& tm, Transaction::Mode mode, Func&& func) {
+template<class Func> static auto transactional(TransactionalMemory const& tm, Transaction::Mode mode, Func&& func, char const* site = __builtin_FUNCTION()) {
+    auto aborts = transactional_aborts ? &(transactional_aborts->get(site)) : nullptr;
+    auto arrivals = transactional_arrivals;
+    auto intended = arrivals ? arrivals->arrive() : Chrono::Tick{0}; // Retries do not postpone the intended start
+    Chrono chrono;
+    size_t retries = 0;
     do {
         try {
+            transactional_retries = retries; // Commits (if ever) at the end of this attempt
+            if (aborts)
+                chrono.start();
+            Aborts::Commit commit{aborts}; // Destroyed after the transaction ends
+            Arrivals::Departure departure{arrivals, intended}; // Destroyed after the transaction ends
             Transaction tx{tm, mode};
             return func(tx);
         } catch (Exception::TransactionRetry const&) {
+            if (aborts) {
+                ++aborts->aborts[static_cast<size_t>(Transaction::last_abort.op)];
+                aborts->wasted_tick += chrono.delta();
+                aborts->wasted_ops += Transaction::last_abort.nbops;
+            }
+            ++retries;
             continue;
         }
     } while (true);
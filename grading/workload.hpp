@@ -24,11 +24,21 @@
 #pragma once
 
 // External headers
+#include <cmath>
+#include <algorithm>
 #include <cstdint>
+#include <initializer_list>
+#include <limits>
 #include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 // Internal headers
 #include "common.hpp"
+#include "transactional.hpp"
 
 // -------------------------------------------------------------------------- //
 
@@ -40,26 +50,124 @@ using Uid = uint_fast32_t;
 **/
 using Seed = uint_fast32_t;
 
+/** Per-worker statistics of the committed transactions, by kind of transaction.
+**/
+class Statistics final {
+public:
+    /** Statistics of one kind of transaction class.
+    **/
+    class Entry final {
+    public:
+        Histogram latency; // Latency of the committed transactions, retries included (in ns)
+        Histogram retries; // Number of retries per committed transaction
+    public:
+        /** Record one committed transaction.
+         * @param tick    Latency of the transaction (in ns)
+         * @param retries Number of retries before it committed
+        **/
+        void record(Chrono::Tick tick, size_t nbretries) noexcept {
+            latency.record(tick);
+            retries.record(nbretries);
+        }
+        /** Add all the transactions recorded in another entry.
+         * @param other Entry to merge
+        **/
+        void merge(Entry const& other) noexcept {
+            latency.merge(other.latency);
+            retries.merge(other.retries);
+        }
+    };
+private:
+    ::std::vector<char const*> names; // Name of each kind of transaction
+    ::std::vector<Entry>     entries; // Entries of each worker, then of each kind
+public:
+    /** Kinds constructor.
+     * @param nbworkers Number of workers recording statistics
+     * @param names     Name of each kind of transaction
+    **/
+    Statistics(size_t nbworkers, ::std::initializer_list<char const*> names): names{names}, entries(nbworkers * names.size()) {}
+public:
+    /** Get the names of the kinds of transaction.
+     * @return Name of each kind of transaction
+    **/
+    auto const& get_names() const noexcept {
+        return names;
+    }
+    /** [thread-safe] Get the entry of one worker for one kind of transaction.
+     * @param uid  Unique ID of the worker
+     * @param kind Index of the kind of transaction
+     * @return Entry only accessed by the given worker
+    **/
+    Entry& get(Uid uid, size_t kind) noexcept {
+        return entries[uid * names.size() + kind];
+    }
+    /** [thread-safe] Clear the entries of one worker.
+     * @param uid Unique ID of the worker
+    **/
+    void reset(Uid uid) noexcept {
+        for (size_t i = 0; i < names.size(); ++i)
+            entries[uid * names.size() + i] = Entry{};
+    }
+    /** Merge the entries of every worker for one kind of transaction.
+     * @param kind Index of the kind of transaction
+     * @return Merged entry
+    **/
+    Entry merged(size_t kind) const noexcept {
+        Entry res;
+        for (size_t i = kind; i < entries.size(); i += names.size())
+            res.merge(entries[i]);
+        return res;
+    }
+};
+
 /** Workload base class.
 **/
 class Workload {
 protected:
     TransactionalLibrary const& tl;  // Associated transactional library
     TransactionalMemory         tm;  // Built transactional memory to use
+    Statistics mutable       stats;  // Statistics of the committed transactions
 public:
     /** Deleted copy constructor/assignment.
     **/
     Workload(Workload const&) = delete;
     Workload& operator=(Workload const&) = delete;
     /** Transactional memory constructor.
-     * @param library Transactional library to use
-     * @param align   Shared memory region required alignment
-     * @param size    Size of the shared memory region to allocate
+     * @param library   Transactional library to use
+     * @param align     Shared memory region required alignment
+     * @param size      Size of the shared memory region to allocate
+     * @param nbworkers Number of workers recording statistics (optional)
+     * @param kinds     Name of each kind of transaction recorded in the statistics (optional)
     **/
-    Workload(TransactionalLibrary const& library, size_t align, size_t size): tl{library}, tm{tl, align, size} {}
+    Workload(TransactionalLibrary const& library, size_t align, size_t size, size_t nbworkers = 0, ::std::initializer_list<char const*> kinds = {}): tl{library}, tm{tl, align, size}, stats{nbworkers, kinds} {}
     /** Virtual destructor.
     **/
     virtual ~Workload() {};
+public:
+    /** Get the transactional memory the workload runs on.
+     * @return Bound transactional memory
+    **/
+    auto const& get_tm() const noexcept {
+        return tm;
+    }
+    /** Get the statistics of the committed transactions, recorded during the runs.
+     * @return Statistics of the committed transactions
+    **/
+    auto const& get_stats() const noexcept {
+        return stats;
+    }
+    /** [thread-safe] Clear the statistics recorded by one worker, e.g. during warmup repetitions.
+     * @param uid Unique ID of the worker
+    **/
+    void reset_stats(Uid uid) const noexcept {
+        stats.reset(uid);
+    }
+    /** Get the workload-specific metrics of the measured repetitions, none by default.
+     * @return Name and value of each metric
+    **/
+    virtual ::std::vector<::std::pair<char const*, double>> get_metrics() const {
+        return {};
+    }
 public:
     /** Shared memory (re)initialization.
      * @return Constant null-terminated error message, 'nullptr' for none
@@ -81,6 +189,118 @@ public:
 
 // -------------------------------------------------------------------------- //
 
+/** Account index distribution class, either uniform or skewed towards the first accounts.
+**/
+class AccountDistribution final {
+public:
+    /** Distribution kind class.
+    **/
+    enum class Kind {
+        uniform, // Every account equally likely
+        zipf,    // Zipfian over the account ranks, account 0 being the most likely
+        hotset   // A fraction of the accounts (the first ones) receiving a given probability mass
+    };
+private:
+    Kind   kind;
+    double theta;    // Zipf skew, in [0, 1)
+    double fraction; // Fraction of the accounts in the hot set
+    double prob;     // Probability of picking an account in the hot set
+    size_t n;        // Number of accounts 'zetan' was computed for
+    double zetan;    // Sum of 1 / i^theta for i in [1, n]
+private:
+    /** Kind constructor.
+     * @param kind     Distribution kind
+     * @param theta    Zipf skew
+     * @param fraction Fraction of the accounts in the hot set
+     * @param prob     Probability of picking an account in the hot set
+    **/
+    AccountDistribution(Kind kind, double theta, double fraction, double prob) noexcept: kind{kind}, theta{theta}, fraction{fraction}, prob{prob}, n{0}, zetan{0.} {}
+public:
+    /** Build a uniform distribution.
+     * @return Uniform distribution
+    **/
+    static AccountDistribution uniform() noexcept {
+        return AccountDistribution{Kind::uniform, 0., 0., 0.};
+    }
+    /** Build a Zipfian distribution (Gray et al., "Quickly generating billion-record synthetic databases").
+     * @param theta Skew, in [0, 1)
+     * @return Zipfian distribution
+    **/
+    static AccountDistribution zipf(double theta) noexcept {
+        return AccountDistribution{Kind::zipf, theta, 0., 0.};
+    }
+    /** Build a hot-set distribution.
+     * @param fraction Fraction of the accounts in the hot set, in (0, 1]
+     * @param prob     Probability of picking an account in the hot set, in [0, 1]
+     * @return Hot-set distribution
+    **/
+    static AccountDistribution hotset(double fraction, double prob) noexcept {
+        return AccountDistribution{Kind::hotset, 0., fraction, prob};
+    }
+public:
+    /** Describe the distribution.
+     * @return Description, e.g. "zipf(0.99)"
+    **/
+    ::std::string describe() const {
+        ::std::ostringstream res;
+        switch (kind) {
+        case Kind::zipf:
+            res << "zipf(" << theta << ")";
+            break;
+        case Kind::hotset:
+            res << "hotset(" << fraction << ", " << prob << ")";
+            break;
+        default:
+            res << "uniform";
+        }
+        return res.str();
+    }
+    /** Pick an account, the distribution being stateful (use one instance per thread).
+     * @param engine Random engine to use
+     * @param count  Non-null number of accounts
+     * @return Account index, in [0, count)
+    **/
+    template<class Engine> size_t operator()(Engine& engine, size_t count) {
+        switch (kind) {
+        case Kind::zipf: {
+            while (n < count) // Incrementally update the normalization constant, the number of accounts slowly drifts
+                zetan += 1. / ::std::pow(static_cast<double>(++n), theta);
+            while (n > count)
+                zetan -= 1. / ::std::pow(static_cast<double>(n--), theta);
+            auto u = ::std::uniform_real_distribution<double>{0., 1.}(engine);
+            auto uz = u * zetan;
+            if (uz < 1. || count == 1)
+                return 0;
+            if (uz < 1. + ::std::pow(0.5, theta))
+                return 1;
+            auto zeta2 = 1. + ::std::pow(0.5, theta);
+            auto eta = (1. - ::std::pow(2. / static_cast<double>(count), 1. - theta)) / (1. - zeta2 / zetan);
+            auto res = static_cast<size_t>(static_cast<double>(count) * ::std::pow(eta * u - eta + 1., 1. / (1. - theta)));
+            return res < count ? res : count - 1;
+        }
+        case Kind::hotset: {
+            auto hot = static_cast<size_t>(fraction * static_cast<double>(count));
+            if (hot == 0)
+                hot = 1;
+            if (hot < count && !::std::bernoulli_distribution{prob}(engine))
+                return ::std::uniform_int_distribution<size_t>{hot, count - 1}(engine);
+            return ::std::uniform_int_distribution<size_t>{0, hot - 1}(engine);
+        }
+        default:
+            return ::std::uniform_int_distribution<size_t>{0, count - 1}(engine);
+        }
+    }
+};
+
+/** Get the bucket of a key in a hash table.
+ * @param key       Key to hash
+ * @param nbbuckets Number of buckets, a power of 2
+ * @return Bucket index
+**/
+static size_t bucket_of(uintptr_t key, size_t nbbuckets) noexcept {
+    return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 32) & (nbbuckets - 1);
+}
+
 /** Bank workload class.
 **/
 class WorkloadBank final: public Workload {
@@ -132,6 +352,14 @@ private:
         **/
         AccountSegment(Transaction& tx, void* address): count{tx, address}, next{tx, count.after()}, parity{tx, next.after()}, accounts{tx, parity.after()} {}
     };
+private:
+    /** Kinds of transaction, in the order given to the statistics.
+    **/
+    enum Kind: size_t {
+        kind_long,
+        kind_short,
+        kind_alloc
+    };
 private:
     size_t  nbworkers;     // Number of concurrent workers
     size_t  nbtxperwrk;    // Number of transactions per worker
@@ -140,6 +368,8 @@ private:
     Balance init_balance;  // Initial account balance
     float   prob_long;     // Probability of running a long, read-only control transaction
     float   prob_alloc;    // Probability of running an allocation/deallocation transaction, knowing a long transaction won't run
+    AccountDistribution distribution; // Distribution of the accounts of the short transactions
+    size_t  batch;         // Number of accounts per short transaction, 2 for a single transfer
     Barrier barrier;       // Barrier for thread synchronization during 'check'
 public:
     /** Bank workload constructor.
@@ -151,8 +381,10 @@ public:
      * @param init_balance  Initial account balance
      * @param prob_long     Probability of running a long, read-only control transaction
      * @param prob_alloc    Probability of running an allocation/deallocation transaction, knowing a long transaction won't run
+     * @param distribution  Distribution of the sender and receiver accounts of the short transactions (optional)
+     * @param batch         Number of accounts read and written per short transaction, above 2 for batch transfers (optional)
     **/
-    WorkloadBank(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbaccounts, size_t expnbaccounts, Balance init_balance, float prob_long, float prob_alloc): Workload{library, AccountSegment::align(), AccountSegment::size(nbaccounts)}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbaccounts{nbaccounts}, expnbaccounts{expnbaccounts}, init_balance{init_balance}, prob_long{prob_long}, prob_alloc{prob_alloc}, barrier{nbworkers} {}
+    WorkloadBank(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbaccounts, size_t expnbaccounts, Balance init_balance, float prob_long, float prob_alloc, AccountDistribution distribution = AccountDistribution::uniform(), size_t batch = 2): Workload{library, AccountSegment::align(), AccountSegment::size(nbaccounts), nbworkers, {"long_tx", batch > 2 ? "batch_tx" : "short_tx", "alloc_tx"}}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbaccounts{nbaccounts}, expnbaccounts{expnbaccounts}, init_balance{init_balance}, prob_long{prob_long}, prob_alloc{prob_alloc}, distribution{distribution}, batch{batch}, barrier{nbworkers} {}
 private:
     /** Long read-only transaction, summing the balance of each account.
      * @param count Loosely-updated number of accounts
@@ -271,6 +503,42 @@ private:
             return true;
         });
     }
+    /** Batch read-write transaction, passing one unit around a ring of accounts, each sending to the next one.
+     * @param ids  Sorted indices of the distinct accounts
+     * @param ptrs     Buffer for the account pointers in shared memory, as many as indices
+     * @param balances Buffer for the balances read, as many as indices
+     * @return Whether the parameters were satisfying and the transaction committed on useful work
+    **/
+    bool batch_tx(::std::vector<size_t> const& ids, ::std::vector<void*>& ptrs, ::std::vector<Balance>& balances) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            // Get the account pointers in shared memory, in a single walk thanks to the sorted indices
+            size_t base = 0;
+            size_t next = 0;
+            auto start = tm.get_start();
+            while (true) {
+                AccountSegment segment{tx, start};
+                size_t segment_count = segment.count;
+                for (; next < ids.size() && ids[next] - base < segment_count; ++next)
+                    ptrs[next] = segment.accounts[ids[next] - base].get();
+                if (next == ids.size())
+                    break;
+                base += segment_count;
+                start = segment.next;
+                if (!start) // Current segment is the last segment
+                    return false; // At least one account does not exist => do nothing
+            }
+            // Read every balance, then write every balance that changed
+            for (size_t i = 0; i < ids.size(); ++i)
+                balances[i] = Shared<Balance>{tx, ptrs[i]}.read();
+            for (size_t i = 0; i < ids.size(); ++i) {
+                auto prev = balances[(i + ids.size() - 1) % ids.size()];
+                auto value = balances[i] - (balances[i] > 0 ? 1 : 0) + (prev > 0 ? 1 : 0);
+                if (value != balances[i])
+                    Shared<Balance>{tx, ptrs[i]} = value;
+            }
+            return true;
+        });
+    }
 public:
     virtual char const* init() const {
         transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
@@ -287,21 +555,61 @@ public:
             return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
         return nullptr;
     }
-    virtual char const* run(Uid uid [[gnu::unused]], Seed seed) const {
+    virtual char const* run(Uid uid, Seed seed) const {
         ::std::minstd_rand engine{seed};
         ::std::bernoulli_distribution long_dist{prob_long};
         ::std::bernoulli_distribution alloc_dist{prob_alloc};
         ::std::gamma_distribution<float> alloc_trigger(expnbaccounts, 1);
+        auto account = distribution;
+        ::std::vector<size_t> ids;
+        ::std::vector<void*> ptrs;
+        ::std::vector<Balance> balances;
+        Chrono chrono;
         size_t count = nbaccounts;
         for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
             if (long_dist(engine)) { // Do a long transaction
+                transactional_pace();
+                chrono.start();
                 if (unlikely(!long_tx(count)))
                     return "Violated isolation or atomicity";
+                stats.get(uid, kind_long).record(chrono.delta(), transactional_retries);
             } else if (alloc_dist(engine)) { // Do an allocation transaction
-                alloc_tx(alloc_trigger(engine));
+                auto trigger = alloc_trigger(engine);
+                transactional_pace();
+                chrono.start();
+                alloc_tx(trigger);
+                stats.get(uid, kind_alloc).record(chrono.delta(), transactional_retries);
+            } else if (batch > 2) { // Do a batch transaction
+                while (true) {
+                    // Draw distinct accounts, giving up on distinctness after a few rounds of duplicates (e.g. tiny hot set)
+                    auto target = ::std::min(batch, count);
+                    ids.clear();
+                    for (size_t round = 0; ids.size() < target && round < 4; ++round) {
+                        while (ids.size() < target)
+                            ids.push_back(account(engine, count));
+                        ::std::sort(ids.begin(), ids.end());
+                        ids.erase(::std::unique(ids.begin(), ids.end()), ids.end());
+                    }
+                    ptrs.resize(ids.size());
+                    balances.resize(ids.size());
+                    transactional_pace();
+                    chrono.start();
+                    auto done = batch_tx(ids, ptrs, balances);
+                    stats.get(uid, kind_short).record(chrono.delta(), transactional_retries);
+                    if (likely(done))
+                        break;
+                }
             } else { // Do a short transaction
-                ::std::uniform_int_distribution<size_t> account{0, count - 1};
-                while (unlikely(!short_tx(account(engine), account(engine))));
+                while (true) {
+                    auto send_id = account(engine, count);
+                    auto recv_id = account(engine, count);
+                    transactional_pace();
+                    chrono.start();
+                    auto done = short_tx(send_id, recv_id);
+                    stats.get(uid, kind_short).record(chrono.delta(), transactional_retries);
+                    if (likely(done))
+                        break;
+                }
             }
         }
         { // Last long transaction
@@ -361,3 +669,1707 @@ public:
         return nullptr;
     }
 };
+
+/** Hash map workload class.
+**/
+class WorkloadHashMap final: public Workload {
+public:
+    /** Key/value class alias.
+    **/
+    using Word = uintptr_t;
+private:
+    /** Shared chained entry class.
+    **/
+    class Node final {
+    private:
+        /** Dummy structure for size and alignment retrieval.
+        **/
+        struct Dummy {
+            Word  dummy0;
+            Word  dummy1;
+            void* dummy2;
+        };
+    public:
+        /** Get the node size.
+         * @return Node size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return sizeof(Dummy);
+        }
+        /** Get the node alignment.
+         * @return Node alignment (in bytes)
+        **/
+        constexpr static auto align() noexcept {
+            return alignof(Dummy);
+        }
+    public:
+        Shared<Word>  key;   // Key of the entry
+        Shared<Word>  value; // Value of the entry, congruent to the key modulo the number of keys
+        Shared<Node*> next;  // Next entry in the same bucket
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Node(Node const&) = delete;
+        Node& operator=(Node const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Node(Transaction& tx, void* address): key{tx, address}, value{tx, key.after()}, next{tx, value.after()} {}
+    };
+    /** Shared bucket array class.
+    **/
+    class Table final {
+    public:
+        /** Get the table size for a given number of buckets.
+         * @param nbbuckets Number of buckets
+         * @return Table size (in bytes)
+        **/
+        constexpr static auto size(size_t nbbuckets) noexcept {
+            return sizeof(size_t) + nbbuckets * sizeof(Node*);
+        }
+    public:
+        Shared<size_t>  nbbuckets; // Number of buckets, a power of 2
+        Shared<Node*[]> buckets;   // Head of the chain of each bucket
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Table(Table const&) = delete;
+        Table& operator=(Table const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Table(Transaction& tx, void* address): nbbuckets{tx, address}, buckets{tx, nbbuckets.after()} {}
+    };
+    /** Kinds of transaction, in the order given to the statistics.
+    **/
+    enum Kind: size_t {
+        kind_get,
+        kind_put,
+        kind_delete,
+        kind_resize
+    };
+    /** Chain length above which a put triggers a resize.
+    **/
+    constexpr static size_t max_chain = 8;
+    /** Initial number of buckets.
+    **/
+    constexpr static size_t init_buckets = 64;
+private:
+    size_t nbworkers;  // Number of concurrent workers
+    size_t nbtxperwrk; // Number of transactions per worker
+    size_t nbkeys;     // Number of distinct keys, the even ones initially present
+    size_t max_buckets; // Maximum number of buckets
+    ::std::vector<unsigned int> mix; // Relative weights of get, put and delete operations
+    AccountDistribution distribution; // Distribution of the keys
+    ::std::vector<long> mutable nets; // Net number of entries inserted by each worker, since the initialization
+    Barrier barrier;   // Barrier for thread synchronization during 'check'
+public:
+    /** Hash map workload constructor.
+     * @param library      Transactional library to use
+     * @param nbworkers    Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk   Number of transactions per worker
+     * @param nbkeys       Number of distinct keys, half of them initially present
+     * @param mix          Relative weights of get, put and delete operations
+     * @param distribution Distribution of the keys (optional)
+    **/
+    WorkloadHashMap(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbkeys, ::std::vector<unsigned int> mix, AccountDistribution distribution = AccountDistribution::uniform()): Workload{library, Node::align(), sizeof(Table*), nbworkers, {"get_tx", "put_tx", "delete_tx", "resize_tx"}}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbkeys{nbkeys}, max_buckets{init_buckets}, mix{::std::move(mix)}, distribution{distribution}, nets(nbworkers, 0), barrier{nbworkers} {
+        while (max_buckets < nbkeys)
+            max_buckets *= 2;
+    }
+private:
+    /** Read-only lookup transaction.
+     * @param key Key to look up
+     * @return Whether the value found (if any) is consistent with the key
+    **/
+    bool get_tx(Word key) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Table table{tx, Shared<Table*>{tx, tm.get_start()}.read()};
+            Node* node = table.buckets[bucket_of(key, table.nbbuckets)];
+            while (node) {
+                Node entry{tx, node};
+                if (entry.key == key)
+                    return entry.value % nbkeys == key;
+                node = entry.next;
+            }
+            return true;
+        });
+    }
+    /** Insertion or update transaction.
+     * @param key   Key to insert or update
+     * @param value Value to associate, congruent to the key
+     * @param chain Set to the length of the chain walked
+     * @return Whether a new entry was inserted
+    **/
+    bool put_tx(Word key, Word value, size_t& chain) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Table table{tx, Shared<Table*>{tx, tm.get_start()}.read()};
+            auto head = table.buckets[bucket_of(key, table.nbbuckets)];
+            Node* node = head;
+            chain = 0;
+            while (node) {
+                Node entry{tx, node};
+                if (entry.key == key) {
+                    entry.value = value;
+                    return false;
+                }
+                node = entry.next;
+                ++chain;
+            }
+            auto addr = tx.alloc(Node::size());
+            Node entry{tx, addr};
+            entry.key = key;
+            entry.value = value;
+            entry.next = head.read();
+            head = reinterpret_cast<Node*>(addr);
+            return true;
+        });
+    }
+    /** Deletion transaction.
+     * @param key Key to delete
+     * @return Whether an entry was deleted
+    **/
+    bool delete_tx(Word key) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Table table{tx, Shared<Table*>{tx, tm.get_start()}.read()};
+            void* link = table.buckets[bucket_of(key, table.nbbuckets)].get();
+            while (true) {
+                Shared<Node*> prev{tx, link};
+                Node* node = prev;
+                if (!node)
+                    return false;
+                Node entry{tx, node};
+                if (entry.key == key) {
+                    prev = entry.next.read();
+                    tx.free(node);
+                    return true;
+                }
+                link = entry.next.get();
+            }
+        });
+    }
+    /** Resize transaction, doubling the number of buckets and relinking every entry.
+     * @param chain Length of the chain that triggered the resize
+     * @param key   Key whose chain triggered the resize
+    **/
+    void resize_tx(size_t chain, Word key) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Shared<Table*> root{tx, tm.get_start()};
+            Table* old_addr = root;
+            Table old_table{tx, old_addr};
+            size_t nbbuckets = old_table.nbbuckets;
+            if (nbbuckets >= max_buckets)
+                return;
+            { // Skip if another resize already shortened the chain
+                size_t length = 0;
+                Node* node = old_table.buckets[bucket_of(key, nbbuckets)];
+                for (; node && length < chain; ++length)
+                    node = Node{tx, node}.next;
+                if (length < chain)
+                    return;
+            }
+            auto new_addr = tx.alloc(Table::size(2 * nbbuckets));
+            Table new_table{tx, new_addr};
+            new_table.nbbuckets = 2 * nbbuckets;
+            for (size_t i = 0; i < nbbuckets; ++i) {
+                Node* node = old_table.buckets[i];
+                while (node) {
+                    Node entry{tx, node};
+                    Node* next = entry.next;
+                    auto head = new_table.buckets[bucket_of(entry.key, 2 * nbbuckets)];
+                    entry.next = head.read();
+                    head = node;
+                    node = next;
+                }
+            }
+            root = reinterpret_cast<Table*>(new_addr);
+            tx.free(old_addr);
+        });
+    }
+public:
+    virtual char const* init() const {
+        // Every worker runs the initialization, only the first one to commit builds the table
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Shared<Table*> root{tx, tm.get_start()};
+            if (root.read())
+                return;
+            Table table{tx, root.alloc(Table::size(init_buckets))};
+            table.nbbuckets = init_buckets;
+            for (Word key = 0; key < nbkeys; key += 2) {
+                auto head = table.buckets[bucket_of(key, init_buckets)];
+                auto addr = tx.alloc(Node::size());
+                Node entry{tx, addr};
+                entry.key = key;
+                entry.value = key;
+                entry.next = head.read();
+                head = reinterpret_cast<Node*>(addr);
+            }
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Table table{tx, Shared<Table*>{tx, tm.get_start()}.read()};
+            return table.nbbuckets >= init_buckets;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::discrete_distribution<size_t> op_dist{mix.begin(), mix.end()};
+        ::std::uniform_int_distribution<Word> stamp_dist{0, 1023};
+        auto key_dist = distribution;
+        Chrono chrono;
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            auto key = static_cast<Word>(key_dist(engine, nbkeys));
+            switch (op_dist(engine)) {
+            case 0: { // Get
+                transactional_pace();
+                chrono.start();
+                auto correct = get_tx(key);
+                stats.get(uid, kind_get).record(chrono.delta(), transactional_retries);
+                if (unlikely(!correct))
+                    return "Violated isolation or atomicity";
+            } break;
+            case 1: { // Put
+                size_t chain;
+                transactional_pace();
+                chrono.start();
+                if (put_tx(key, key + nbkeys * stamp_dist(engine), chain))
+                    ++nets[uid];
+                stats.get(uid, kind_put).record(chrono.delta(), transactional_retries);
+                if (chain > max_chain) {
+                    transactional_pace();
+                    chrono.start();
+                    resize_tx(chain, key);
+                    stats.get(uid, kind_resize).record(chrono.delta(), transactional_retries);
+                }
+            } break;
+            default: { // Delete
+                transactional_pace();
+                chrono.start();
+                if (delete_tx(key))
+                    --nets[uid];
+                stats.get(uid, kind_delete).record(chrono.delta(), transactional_retries);
+            }
+            }
+        }
+        return nullptr;
+    }
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        barrier.sync();
+        if (uid != 0)
+            return nullptr;
+        // Expected number of entries
+        long expected = static_cast<long>((nbkeys + 1) / 2);
+        for (auto net: nets)
+            expected += net;
+        // Every entry in its bucket, once, with a consistent value
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            Table table{tx, Shared<Table*>{tx, tm.get_start()}.read()};
+            size_t nbbuckets = table.nbbuckets;
+            ::std::vector<bool> seen(nbkeys, false);
+            long count = 0;
+            for (size_t i = 0; i < nbbuckets; ++i) {
+                Node* node = table.buckets[i];
+                while (node) {
+                    Node entry{tx, node};
+                    Word key = entry.key;
+                    if (unlikely(key >= nbkeys || seen[key] || bucket_of(key, nbbuckets) != i || entry.value % nbkeys != key))
+                        return "Violated consistency, isolation or atomicity";
+                    seen[key] = true;
+                    ++count;
+                    node = entry.next;
+                }
+            }
+            if (unlikely(count != expected))
+                return "Violated consistency, isolation or atomicity";
+            return nullptr;
+        });
+    }
+};
+
+/** Skip list set workload class.
+**/
+class WorkloadSkipList final: public Workload {
+public:
+    /** Key class alias.
+    **/
+    using Word = uintptr_t;
+private:
+    /** Shared node class, the head node being at the start of the shared memory region.
+    **/
+    class Node final {
+    private:
+        /** Dummy structure for size and alignment retrieval.
+        **/
+        struct Dummy {
+            Word  dummy0;
+            Word  dummy1;
+            void* dummy2[];
+        };
+    public:
+        /** Get the node size for a given level.
+         * @param level Number of lists the node belongs to
+         * @return Node size (in bytes)
+        **/
+        constexpr static auto size(size_t level) noexcept {
+            return sizeof(Dummy) + level * sizeof(void*);
+        }
+        /** Get the node alignment.
+         * @return Node alignment (in bytes)
+        **/
+        constexpr static auto align() noexcept {
+            return alignof(Dummy);
+        }
+    public:
+        Shared<Word>    key;   // Key of the element (unused for the head)
+        Shared<Word>    level; // Number of lists the node belongs to
+        Shared<Node*[]> next;  // Next node in each list, from the densest one
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Node(Node const&) = delete;
+        Node& operator=(Node const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Node(Transaction& tx, void* address): key{tx, address}, level{tx, key.after()}, next{tx, level.after()} {}
+    };
+    /** Kinds of transaction, in the order given to the statistics.
+    **/
+    enum Kind: size_t {
+        kind_contains,
+        kind_insert,
+        kind_remove
+    };
+private:
+    size_t nbworkers;  // Number of concurrent workers
+    size_t nbtxperwrk; // Number of transactions per worker
+    size_t nbkeys;     // Number of distinct keys, the even ones initially present
+    size_t levels;     // Number of lists of the head node
+    ::std::vector<unsigned int> mix; // Relative weights of contains, insert and remove operations
+    AccountDistribution distribution; // Distribution of the keys
+    ::std::vector<long> mutable nets; // Net number of elements inserted by each worker, since the initialization
+    Barrier barrier;   // Barrier for thread synchronization during 'check'
+public:
+    /** Skip list workload constructor.
+     * @param library      Transactional library to use
+     * @param nbworkers    Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk   Number of transactions per worker
+     * @param nbkeys       Number of distinct keys, half of them initially present
+     * @param mix          Relative weights of contains, insert and remove operations
+     * @param distribution Distribution of the keys (optional)
+    **/
+    WorkloadSkipList(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbkeys, ::std::vector<unsigned int> mix, AccountDistribution distribution = AccountDistribution::uniform()): Workload{library, Node::align(), Node::size(levels_for(nbkeys)), nbworkers, {"contains_tx", "insert_tx", "remove_tx"}}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbkeys{nbkeys}, levels{levels_for(nbkeys)}, mix{::std::move(mix)}, distribution{distribution}, nets(nbworkers, 0), barrier{nbworkers} {}
+private:
+    /** Get the number of lists suited to a number of keys.
+     * @param nbkeys Number of distinct keys
+     * @return Number of lists of the head node
+    **/
+    constexpr static size_t levels_for(size_t nbkeys) noexcept {
+        size_t res = 1;
+        while (nbkeys >>= 1)
+            ++res;
+        return res;
+    }
+    /** Draw the level of a new node, following a geometric distribution of parameter 1/2.
+     * @param engine Random engine to use
+     * @return Number of lists the node belongs to
+    **/
+    template<class Engine> size_t draw_level(Engine& engine) const {
+        size_t res = 1;
+        while (res < levels && ::std::bernoulli_distribution{0.5}(engine))
+            ++res;
+        return res;
+    }
+    /** Find the last node with a smaller key in each list.
+     * @param tx    Associated pending transaction
+     * @param key   Key to look for
+     * @param preds Set to the last node with a smaller key in each list, as many as lists
+     * @return First node with a key greater or equal, 'nullptr' if none
+    **/
+    Node* find(Transaction& tx, Word key, void** preds) const {
+        void* pred = tm.get_start();
+        for (auto level = levels; level-- > 0;) {
+            while (true) {
+                Node* next = Node{tx, pred}.next[level];
+                if (!next || Node{tx, next}.key >= key)
+                    break;
+                pred = next;
+            }
+            preds[level] = pred;
+        }
+        return Node{tx, pred}.next[0];
+    }
+    /** Read-only membership transaction.
+     * @param key   Key to look for
+     * @param preds Buffer for the predecessors, as many as lists
+     * @return Whether the key is in the set
+    **/
+    bool contains_tx(Word key, void** preds) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            auto node = find(tx, key, preds);
+            return node && Node{tx, node}.key == key;
+        });
+    }
+    /** Insertion transaction.
+     * @param key   Key to insert
+     * @param level Number of lists the new node would belong to
+     * @param preds Buffer for the predecessors, as many as lists
+     * @return Whether the key was inserted
+    **/
+    bool insert_tx(Word key, size_t level, void** preds) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto node = find(tx, key, preds);
+            if (node && Node{tx, node}.key == key)
+                return false;
+            auto addr = tx.alloc(Node::size(level));
+            Node entry{tx, addr};
+            entry.key = key;
+            entry.level = level;
+            for (size_t i = 0; i < level; ++i) {
+                auto link = Node{tx, preds[i]}.next[i];
+                entry.next[i] = link.read();
+                link = reinterpret_cast<Node*>(addr);
+            }
+            return true;
+        });
+    }
+    /** Removal transaction.
+     * @param key   Key to remove
+     * @param preds Buffer for the predecessors, as many as lists
+     * @return Whether the key was removed
+    **/
+    bool remove_tx(Word key, void** preds) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            auto node = find(tx, key, preds);
+            if (!node)
+                return false;
+            Node entry{tx, node};
+            if (entry.key != key)
+                return false;
+            size_t level = entry.level;
+            for (size_t i = 0; i < level; ++i)
+                Node{tx, preds[i]}.next[i] = entry.next[i].read();
+            tx.free(node);
+            return true;
+        });
+    }
+public:
+    virtual char const* init() const {
+        // Every worker runs the initialization, only the first one to commit builds the list
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Node head{tx, tm.get_start()};
+            if (head.level != 0)
+                return;
+            head.level = levels;
+            ::std::minstd_rand engine{static_cast<Seed>(nbkeys)};
+            ::std::vector<void*> tails(levels, tm.get_start());
+            for (Word key = 0; key < nbkeys; key += 2) {
+                auto level = draw_level(engine);
+                auto addr = tx.alloc(Node::size(level));
+                Node entry{tx, addr};
+                entry.key = key;
+                entry.level = level;
+                for (size_t i = 0; i < level; ++i) {
+                    Node{tx, tails[i]}.next[i] = reinterpret_cast<Node*>(addr);
+                    tails[i] = addr;
+                }
+            }
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Node head{tx, tm.get_start()};
+            return head.level == levels;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::discrete_distribution<size_t> op_dist{mix.begin(), mix.end()};
+        ::std::vector<void*> preds(levels);
+        auto key_dist = distribution;
+        Chrono chrono;
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            auto key = static_cast<Word>(key_dist(engine, nbkeys));
+            switch (op_dist(engine)) {
+            case 0: // Contains
+                transactional_pace();
+                chrono.start();
+                contains_tx(key, preds.data());
+                stats.get(uid, kind_contains).record(chrono.delta(), transactional_retries);
+                break;
+            case 1: { // Insert
+                auto level = draw_level(engine);
+                transactional_pace();
+                chrono.start();
+                if (insert_tx(key, level, preds.data()))
+                    ++nets[uid];
+                stats.get(uid, kind_insert).record(chrono.delta(), transactional_retries);
+            } break;
+            default: // Remove
+                transactional_pace();
+                chrono.start();
+                if (remove_tx(key, preds.data()))
+                    --nets[uid];
+                stats.get(uid, kind_remove).record(chrono.delta(), transactional_retries);
+            }
+        }
+        return nullptr;
+    }
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        barrier.sync();
+        if (uid != 0)
+            return nullptr;
+        // Expected number of elements
+        long expected = static_cast<long>((nbkeys + 1) / 2);
+        for (auto net: nets)
+            expected += net;
+        // Every list sorted, each node in exactly the lists of its level, and the densest list of the expected size
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            ::std::vector<Node*> expect(levels, nullptr); // Next node expected in each list, from the densest list
+            for (size_t i = 0; i < levels; ++i)
+                expect[i] = Node{tx, tm.get_start()}.next[i];
+            long count = 0;
+            Word last = 0;
+            for (Node* node = expect[0]; node; node = Node{tx, node}.next[0]) {
+                Node entry{tx, node};
+                Word key = entry.key;
+                size_t level = entry.level;
+                if (unlikely(key >= nbkeys || (count > 0 && key <= last) || level == 0 || level > levels))
+                    return "Violated consistency, isolation or atomicity";
+                for (size_t i = 0; i < level; ++i) {
+                    if (unlikely(expect[i] != node))
+                        return "Violated consistency, isolation or atomicity";
+                    expect[i] = entry.next[i];
+                }
+                last = key;
+                ++count;
+            }
+            for (size_t i = 1; i < levels; ++i) {
+                if (unlikely(expect[i] != nullptr))
+                    return "Violated consistency, isolation or atomicity";
+            }
+            if (unlikely(count != expected))
+                return "Violated consistency, isolation or atomicity";
+            return nullptr;
+        });
+    }
+};
+
+/** Bounded producer/consumer queue workload class.
+**/
+class WorkloadQueue final: public Workload {
+public:
+    /** Item class alias.
+    **/
+    using Word = uintptr_t;
+private:
+    /** Shared ring buffer class, at the start of the shared memory region.
+    **/
+    class Ring final {
+    public:
+        /** Get the ring size for a given capacity.
+         * @param capacity Number of slots
+         * @return Ring size (in bytes)
+        **/
+        constexpr static auto size(size_t capacity) noexcept {
+            return (2 + capacity) * sizeof(Word);
+        }
+    public:
+        Shared<Word>   head;  // Number of items ever dequeued
+        Shared<Word>   tail;  // Number of items ever enqueued
+        Shared<Word[]> slots; // Items, the one of index 'i' at slot 'i % capacity'
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Ring(Ring const&) = delete;
+        Ring& operator=(Ring const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Ring(Transaction& tx, void* address): head{tx, address}, tail{tx, head.after()}, slots{tx, tail.after()} {}
+    };
+    /** Per-worker tally of the items, for the final check.
+    **/
+    struct alignas(64) Tally {
+        Word produced = 0;      // Number of items enqueued
+        Word produced_hash = 0; // Sum of the hashes of the items enqueued
+        Word consumed = 0;      // Number of items dequeued
+        Word consumed_hash = 0; // Sum of the hashes of the items dequeued
+        ::std::vector<Word> lasts; // Sequence number of the last item dequeued from each producer
+    };
+    /** Kinds of transaction, in the order given to the statistics.
+    **/
+    enum Kind: size_t {
+        kind_enqueue,
+        kind_dequeue,
+        kind_idle
+    };
+    /** Number of bits of an item holding the sequence number, the producer ID being above.
+    **/
+    constexpr static unsigned int seq_bits = 40;
+private:
+    size_t nbworkers;  // Number of concurrent workers
+    size_t nbtxperwrk; // Number of transactions per worker
+    size_t capacity;   // Number of slots of the ring
+    ::std::vector<Tally> mutable tallies; // Tally of each worker, since the initialization
+    Barrier barrier;   // Barrier for thread synchronization during 'check'
+public:
+    /** Queue workload constructor.
+     * @param library    Transactional library to use
+     * @param nbworkers  Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk Number of transactions per worker
+     * @param capacity   Number of slots of the queue
+    **/
+    WorkloadQueue(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t capacity): Workload{library, alignof(Word), Ring::size(capacity), nbworkers, {"enqueue_tx", "dequeue_tx", "idle_tx"}}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, capacity{capacity}, tallies(nbworkers), barrier{nbworkers} {
+        for (auto&& tally: tallies)
+            tally.lasts.resize(nbworkers, 0);
+    }
+private:
+    /** Hash an item for the checksums.
+     * @param item Item to hash
+     * @return Hash of the item
+    **/
+    static Word hash(Word item) noexcept {
+        return item * static_cast<Word>(0x9E3779B97F4A7C15ull);
+    }
+    /** Enqueue transaction.
+     * @param item Item to enqueue
+     * @return Whether there was room for the item
+    **/
+    bool enqueue_tx(Word item) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Ring ring{tx, tm.get_start()};
+            Word head = ring.head;
+            Word tail = ring.tail;
+            if (tail - head >= capacity)
+                return false;
+            ring.slots[tail % capacity] = item;
+            ring.tail = tail + 1;
+            return true;
+        });
+    }
+    /** Dequeue transaction.
+     * @param item Set to the item dequeued
+     * @return Whether there was an item
+    **/
+    bool dequeue_tx(Word& item) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Ring ring{tx, tm.get_start()};
+            Word head = ring.head;
+            Word tail = ring.tail;
+            if (head == tail)
+                return false;
+            item = ring.slots[head % capacity];
+            ring.head = head + 1;
+            return true;
+        });
+    }
+public:
+    virtual ::std::vector<::std::pair<char const*, double>> get_metrics() const {
+        // Jain's fairness index of the number of items moved by each worker, all workers making as many attempts
+        double sum = 0;
+        double sum_sq = 0;
+        double enqueued = 0;
+        double dequeued = 0;
+        for (Uid uid = 0; uid < nbworkers; ++uid) {
+            auto enqueues = static_cast<double>(stats.get(uid, kind_enqueue).latency.get_count());
+            auto dequeues = static_cast<double>(stats.get(uid, kind_dequeue).latency.get_count());
+            enqueued += enqueues;
+            dequeued += dequeues;
+            sum += enqueues + dequeues;
+            sum_sq += (enqueues + dequeues) * (enqueues + dequeues);
+        }
+        auto fairness = sum_sq > 0 ? sum * sum / (static_cast<double>(nbworkers) * sum_sq) : 1.;
+        return {{"enqueued", enqueued}, {"dequeued", dequeued}, {"fairness", fairness}};
+    }
+    virtual char const* init() const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Ring ring{tx, tm.get_start()};
+            ring.head = 0;
+            ring.tail = 0;
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Ring ring{tx, tm.get_start()};
+            return ring.head == ring.tail;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    virtual char const* run(Uid uid, Seed seed [[gnu::unused]]) const {
+        // Even workers produce and odd ones consume, the last one alternating if the number of workers is odd
+        auto mixed = nbworkers % 2 == 1 && uid + 1 == nbworkers;
+        auto& tally = tallies[uid];
+        Chrono chrono;
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            if (mixed ? cntr % 2 == 0 : uid % 2 == 0) { // Enqueue
+                auto item = (static_cast<Word>(uid + 1) << seq_bits) | (tally.produced + 1);
+                transactional_pace();
+                chrono.start();
+                auto done = enqueue_tx(item);
+                stats.get(uid, done ? kind_enqueue : kind_idle).record(chrono.delta(), transactional_retries);
+                if (done) {
+                    ++tally.produced;
+                    tally.produced_hash += hash(item);
+                } else { // Back off on a full queue
+                    short_pause();
+                }
+            } else { // Dequeue
+                Word item;
+                transactional_pace();
+                chrono.start();
+                auto done = dequeue_tx(item);
+                stats.get(uid, done ? kind_dequeue : kind_idle).record(chrono.delta(), transactional_retries);
+                if (done) {
+                    // Items of a same producer must come out in order
+                    auto producer = (item >> seq_bits) - 1;
+                    auto seq = item & ((static_cast<Word>(1) << seq_bits) - 1);
+                    if (unlikely(producer >= nbworkers || seq <= tally.lasts[producer]))
+                        return "Violated isolation or atomicity";
+                    tally.lasts[producer] = seq;
+                    ++tally.consumed;
+                    tally.consumed_hash += hash(item);
+                } else { // Back off on an empty queue
+                    short_pause();
+                }
+            }
+        }
+        return nullptr;
+    }
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        barrier.sync();
+        if (uid != 0)
+            return nullptr;
+        // Every item enqueued has been dequeued exactly once, or is still queued
+        Word produced = 0;
+        Word produced_hash = 0;
+        Word consumed = 0;
+        Word consumed_hash = 0;
+        for (auto&& tally: tallies) {
+            produced += tally.produced;
+            produced_hash += tally.produced_hash;
+            consumed += tally.consumed;
+            consumed_hash += tally.consumed_hash;
+        }
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            Ring ring{tx, tm.get_start()};
+            Word head = ring.head;
+            Word tail = ring.tail;
+            if (unlikely(tail - head > capacity || tail != produced || head != consumed))
+                return "Violated consistency, isolation or atomicity";
+            auto queued_hash = consumed_hash;
+            for (auto i = head; i != tail; ++i)
+                queued_hash += hash(ring.slots[i % capacity]);
+            if (unlikely(queued_hash != produced_hash))
+                return "Violated consistency, isolation or atomicity";
+            return nullptr;
+        });
+    }
+};
+
+/** Reservation system workload class, modeled on STAMP's vacation.
+**/
+class WorkloadVacation final: public Workload {
+public:
+    /** Word class alias.
+    **/
+    using Word = uintptr_t;
+    /** Reservable resource types, each with its own table.
+    **/
+    enum Type: size_t {
+        type_car,
+        type_flight,
+        type_room,
+        nbtypes
+    };
+private:
+    /** Shared reservable relation class, chained in the table of its type.
+    **/
+    class Relation final {
+    public:
+        /** Get the relation size.
+         * @return Relation size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return 6 * sizeof(Word);
+        }
+    public:
+        Shared<Word>      key;   // Relation ID
+        Shared<Relation*> next;  // Next relation in the same bucket
+        Shared<Word>      total; // Number of units
+        Shared<Word>      used;  // Number of units reserved
+        Shared<Word>      free;  // Number of units available, always 'total - used'
+        Shared<Word>      price; // Unit price
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Relation(Relation const&) = delete;
+        Relation& operator=(Relation const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Relation(Transaction& tx, void* address): key{tx, address}, next{tx, key.after()}, total{tx, next.after()}, used{tx, total.after()}, free{tx, used.after()}, price{tx, free.after()} {}
+    };
+    /** Shared reservation class, chained in the list of its customer.
+    **/
+    class Reservation final {
+    public:
+        /** Get the reservation size.
+         * @return Reservation size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return 4 * sizeof(Word);
+        }
+    public:
+        Shared<Word>         type;  // Type of the relation reserved
+        Shared<Word>         id;    // ID of the relation reserved
+        Shared<Word>         price; // Price paid
+        Shared<Reservation*> next;  // Next reservation of the same customer
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Reservation(Reservation const&) = delete;
+        Reservation& operator=(Reservation const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Reservation(Transaction& tx, void* address): type{tx, address}, id{tx, type.after()}, price{tx, id.after()}, next{tx, price.after()} {}
+    };
+    /** Shared customer class, chained in the customer table.
+    **/
+    class Customer final {
+    public:
+        /** Get the customer size.
+         * @return Customer size (in bytes)
+        **/
+        constexpr static auto size() noexcept {
+            return 3 * sizeof(Word);
+        }
+    public:
+        Shared<Word>         key;          // Customer ID
+        Shared<Customer*>    next;         // Next customer in the same bucket
+        Shared<Reservation*> reservations; // Reservations of the customer
+    public:
+        /** Deleted copy constructor/assignment.
+        **/
+        Customer(Customer const&) = delete;
+        Customer& operator=(Customer const&) = delete;
+        /** Binding constructor.
+         * @param tx      Associated pending transaction
+         * @param address Block base address
+        **/
+        Customer(Transaction& tx, void* address): key{tx, address}, next{tx, key.after()}, reservations{tx, next.after()} {}
+    };
+    /** Kinds of transaction, in the order given to the statistics.
+    **/
+    enum Kind: size_t {
+        kind_reserve,
+        kind_delete,
+        kind_update
+    };
+    /** Index of the customer table, after the relation tables.
+    **/
+    constexpr static size_t customers = nbtypes;
+    /** Number of units added or removed by a table update.
+    **/
+    constexpr static Word units = 100;
+private:
+    size_t nbworkers;   // Number of concurrent workers
+    size_t nbtxperwrk;  // Number of transactions per worker
+    size_t nbrelations; // Initial number of relations per table, and number of customer IDs
+    size_t nbqueries;   // Number of relations queried per transaction
+    size_t range;       // Number of relation and customer IDs drawn from
+    float  prob_user;   // Probability of a reservation, the rest split evenly between customer deletions and table updates
+    size_t nbbuckets;   // Number of buckets per table
+    Barrier barrier;    // Barrier for thread synchronization during 'check'
+public:
+    /** Vacation workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param nbrelations Initial number of relations per table, and number of customer IDs
+     * @param nbqueries   Number of relations queried per transaction
+     * @param range       Percentage of the IDs drawn from
+     * @param prob_user   Probability of a reservation, the rest split evenly between customer deletions and table updates
+    **/
+    WorkloadVacation(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbrelations, size_t nbqueries, size_t range, float prob_user): Workload{library, alignof(Word), (1 + (nbtypes + 1) * buckets_for(nbrelations)) * sizeof(Word), nbworkers, {"reserve_tx", "delete_customer_tx", "update_tables_tx"}}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbrelations{nbrelations}, nbqueries{nbqueries}, range{::std::max<size_t>(1, nbrelations * range / 100)}, prob_user{prob_user}, nbbuckets{buckets_for(nbrelations)}, barrier{nbworkers} {}
+private:
+    /** Get the number of buckets per table suited to a number of relations.
+     * @param nbrelations Number of relations per table
+     * @return Number of buckets, a power of 2
+    **/
+    constexpr static size_t buckets_for(size_t nbrelations) noexcept {
+        size_t res = 1;
+        while (2 * res < nbrelations)
+            res *= 2;
+        return res;
+    }
+    /** Get the address of the link to the entry of a key in a table, all entries starting with their key and next pointer.
+     * @param tx    Associated pending transaction
+     * @param table Index of the table
+     * @param key   Key to look for
+     * @return Address of the link holding the entry, or holding 'nullptr' if the key is absent
+    **/
+    void* locate(Transaction& tx, size_t table, Word key) const {
+        void* link = reinterpret_cast<Word*>(tm.get_start()) + 1 + table * nbbuckets + bucket_of(key, nbbuckets);
+        while (true) {
+            Word* entry = Shared<Word*>{tx, link};
+            if (!entry || Shared<Word>{tx, entry} == key)
+                return link;
+            link = entry + 1;
+        }
+    }
+    /** Reservation transaction, reserving the most expensive available relation of each type among the queried ones.
+     * @param customer ID of the customer
+     * @param queries  Type and ID of each relation to query
+    **/
+    void reserve_tx(Word customer, ::std::vector<::std::pair<size_t, Word>> const& queries) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Relation* best[nbtypes] = {};
+            Word best_price[nbtypes] = {};
+            for (auto&& query: queries) {
+                Relation* addr = Shared<Relation*>{tx, locate(tx, query.first, query.second)};
+                if (!addr)
+                    continue;
+                Relation relation{tx, addr};
+                Word price = relation.price;
+                if (relation.free > 0 && price > best_price[query.first]) {
+                    best[query.first] = addr;
+                    best_price[query.first] = price;
+                }
+            }
+            if (!best[type_car] && !best[type_flight] && !best[type_room])
+                return;
+            Shared<Customer*> link{tx, locate(tx, customers, customer)};
+            Customer* addr = link;
+            if (!addr) {
+                addr = link.alloc(Customer::size());
+                Customer{tx, addr}.key = customer;
+            }
+            Customer client{tx, addr};
+            for (size_t type = 0; type < nbtypes; ++type) {
+                if (!best[type])
+                    continue;
+                Relation relation{tx, best[type]};
+                relation.used = relation.used + 1;
+                relation.free = relation.free - 1;
+                auto info = tx.alloc(Reservation::size());
+                Reservation reservation{tx, info};
+                reservation.type = type;
+                reservation.id = relation.key.read();
+                reservation.price = best_price[type];
+                reservation.next = client.reservations.read();
+                client.reservations = reinterpret_cast<Reservation*>(info);
+            }
+        });
+    }
+    /** Customer deletion transaction, cancelling all its reservations.
+     * @param customer ID of the customer
+     * @return Whether every reservation was found in the tables
+    **/
+    bool delete_customer_tx(Word customer) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Shared<Customer*> link{tx, locate(tx, customers, customer)};
+            Customer* addr = link;
+            if (!addr)
+                return true;
+            Customer client{tx, addr};
+            Reservation* info = client.reservations;
+            while (info) {
+                Reservation reservation{tx, info};
+                Relation* target = Shared<Relation*>{tx, locate(tx, reservation.type, reservation.id)};
+                if (unlikely(!target))
+                    return false;
+                Relation relation{tx, target};
+                relation.used = relation.used - 1;
+                relation.free = relation.free + 1;
+                Reservation* next = reservation.next;
+                tx.free(info);
+                info = next;
+            }
+            link = client.next.read();
+            tx.free(addr);
+            return true;
+        });
+    }
+    /** Table update transaction, adding units to relations (possibly new) or removing available units.
+     * @param updates Type, ID, whether to add and new price of each relation to update
+    **/
+    void update_tables_tx(::std::vector<::std::tuple<size_t, Word, bool, Word>> const& updates) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            for (auto&& update: updates) {
+                Shared<Relation*> link{tx, locate(tx, ::std::get<0>(update), ::std::get<1>(update))};
+                Relation* addr = link;
+                if (::std::get<2>(update)) { // Add units
+                    if (!addr) {
+                        addr = link.alloc(Relation::size());
+                        Relation{tx, addr}.key = ::std::get<1>(update);
+                    }
+                    Relation relation{tx, addr};
+                    relation.total = relation.total + units;
+                    relation.free = relation.free + units;
+                    relation.price = ::std::get<3>(update);
+                } else if (addr) { // Remove available units, and the relation once empty
+                    Relation relation{tx, addr};
+                    Word free = relation.free;
+                    if (free < units)
+                        continue;
+                    Word total = relation.total - units;
+                    if (total == 0) {
+                        link = relation.next.read();
+                        tx.free(addr);
+                    } else {
+                        relation.total = total;
+                        relation.free = free - units;
+                    }
+                }
+            }
+        });
+    }
+public:
+    virtual char const* init() const {
+        // Every worker runs the initialization, only the one claiming it fills the tables, one ID per transaction
+        auto claimed = transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Shared<Word> ready{tx, tm.get_start()};
+            if (ready.read())
+                return false;
+            ready = 1;
+            return true;
+        });
+        if (claimed) {
+            ::std::minstd_rand engine{static_cast<Seed>(nbrelations)};
+            ::std::uniform_int_distribution<Word> count_dist{1, 5};
+            for (Word id = 0; id < nbrelations; ++id) {
+                Word totals[nbtypes];
+                Word prices[nbtypes];
+                for (size_t type = 0; type < nbtypes; ++type) {
+                    totals[type] = count_dist(engine) * units;
+                    prices[type] = count_dist(engine) * 10 + 50;
+                }
+                transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+                    for (size_t type = 0; type < nbtypes; ++type) {
+                        Shared<Relation*> link{tx, locate(tx, type, id)};
+                        Relation relation{tx, link.alloc(Relation::size())};
+                        relation.key = id;
+                        relation.total = totals[type];
+                        relation.free = totals[type];
+                        relation.price = prices[type];
+                    }
+                });
+            }
+        }
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            return Shared<Word>{tx, tm.get_start()} == 1;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::uniform_real_distribution<float> action_dist{0, 1};
+        ::std::uniform_int_distribution<size_t> type_dist{0, nbtypes - 1};
+        ::std::uniform_int_distribution<Word> id_dist{0, range - 1};
+        ::std::uniform_int_distribution<Word> price_dist{5, 50};
+        ::std::bernoulli_distribution add_dist{0.5};
+        ::std::vector<::std::pair<size_t, Word>> queries(nbqueries);
+        ::std::vector<::std::tuple<size_t, Word, bool, Word>> updates(nbqueries);
+        Chrono chrono;
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            auto action = action_dist(engine);
+            if (action < prob_user) { // Make a reservation
+                auto customer = id_dist(engine);
+                for (auto&& query: queries)
+                    query = {type_dist(engine), id_dist(engine)};
+                transactional_pace();
+                chrono.start();
+                reserve_tx(customer, queries);
+                stats.get(uid, kind_reserve).record(chrono.delta(), transactional_retries);
+            } else if (action < prob_user + (1 - prob_user) / 2) { // Delete a customer
+                auto customer = id_dist(engine);
+                transactional_pace();
+                chrono.start();
+                auto correct = delete_customer_tx(customer);
+                stats.get(uid, kind_delete).record(chrono.delta(), transactional_retries);
+                if (unlikely(!correct))
+                    return "Violated isolation or atomicity";
+            } else { // Update the tables
+                for (auto&& update: updates)
+                    update = {type_dist(engine), id_dist(engine), add_dist(engine), price_dist(engine) * 10};
+                transactional_pace();
+                chrono.start();
+                update_tables_tx(updates);
+                stats.get(uid, kind_update).record(chrono.delta(), transactional_retries);
+            }
+        }
+        return nullptr;
+    }
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        barrier.sync();
+        if (uid != 0)
+            return nullptr;
+        // Every relation with consistent counts, reserved exactly as many times as the customers' reservations say
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) -> char const* {
+            ::std::vector<Word> reserved(nbtypes * nbrelations, 0);
+            auto buckets = reinterpret_cast<Word*>(tm.get_start()) + 1;
+            for (size_t i = 0; i < nbbuckets; ++i) {
+                for (Customer* addr = Shared<Customer*>{tx, buckets + customers * nbbuckets + i}; addr; addr = Customer{tx, addr}.next) {
+                    for (Reservation* info = Customer{tx, addr}.reservations; info; info = Reservation{tx, info}.next) {
+                        Reservation reservation{tx, info};
+                        Word type = reservation.type;
+                        Word id = reservation.id;
+                        if (unlikely(type >= nbtypes || id >= nbrelations))
+                            return "Violated consistency, isolation or atomicity";
+                        ++reserved[type * nbrelations + id];
+                    }
+                }
+            }
+            for (size_t type = 0; type < nbtypes; ++type) {
+                for (size_t i = 0; i < nbbuckets; ++i) {
+                    for (Relation* addr = Shared<Relation*>{tx, buckets + type * nbbuckets + i}; addr; addr = Relation{tx, addr}.next) {
+                        Relation relation{tx, addr};
+                        Word id = relation.key;
+                        Word used = relation.used;
+                        if (unlikely(id >= nbrelations || used + relation.free != relation.total || used != reserved[type * nbrelations + id]))
+                            return "Violated consistency, isolation or atomicity";
+                        reserved[type * nbrelations + id] = 0;
+                    }
+                }
+            }
+            for (auto count: reserved) {
+                if (unlikely(count != 0)) // Reservation of a deleted relation
+                    return "Violated consistency, isolation or atomicity";
+            }
+            return nullptr;
+        });
+    }
+};
+
+/** K-means clustering workload class, modeled on STAMP's kmeans.
+**/
+class WorkloadKMeans final: public Workload {
+public:
+    /** Coordinate class alias.
+    **/
+    using Word = uintptr_t;
+private:
+    /** Kinds of transaction, in the order given to the statistics.
+    **/
+    enum Kind: size_t {
+        kind_accumulate,
+        kind_recompute,
+        kind_centers
+    };
+    /** Exclusive upper bound of a coordinate.
+    **/
+    constexpr static Word max_coord = 1024;
+private:
+    size_t nbworkers;   // Number of concurrent workers
+    size_t nbtxperwrk;  // Number of transactions per worker
+    size_t nbclusters;  // Number of clusters
+    size_t nbdims;      // Number of dimensions of a point
+    size_t nbpoints;    // Number of points per worker, each accumulated once per iteration
+    ::std::vector<Word> points; // Coordinates of the points, the ones of worker 'i' from index 'i * nbpoints * nbdims'
+    ::std::vector<Word> totals; // Sum of the coordinates of every point, for each dimension
+    ::std::atomic<bool> mutable failed; // Whether an iteration failed its check, for the other workers to stop
+    Barrier barrier;    // Barrier for thread synchronization between iterations
+public:
+    /** K-means workload constructor.
+     * @param library    Transactional library to use
+     * @param nbworkers  Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk Number of transactions per worker
+     * @param nbclusters Number of clusters
+     * @param nbdims     Number of dimensions of a point
+     * @param nbpoints   Number of points per worker (at most the number of transactions per worker)
+    **/
+    WorkloadKMeans(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t nbclusters, size_t nbdims, size_t nbpoints): Workload{library, alignof(Word), (nbclusters * (2 * nbdims + 1)) * sizeof(Word), nbworkers, {"accumulate_tx", "recompute_tx", "centers_tx"}}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbclusters{nbclusters}, nbdims{nbdims}, nbpoints{::std::max<size_t>(1, ::std::min(nbpoints, nbtxperwrk))}, points(nbworkers * this->nbpoints * nbdims), totals(nbdims, 0), failed{false}, barrier{nbworkers} {
+        // Points scattered around as many random centers as clusters
+        ::std::minstd_rand engine{static_cast<Seed>(nbclusters * nbdims)};
+        ::std::uniform_int_distribution<Word> coord_dist{max_coord / 8, max_coord - max_coord / 8 - 1};
+        ::std::uniform_int_distribution<size_t> cluster_dist{0, nbclusters - 1};
+        ::std::uniform_int_distribution<Word> noise_dist{0, max_coord / 4 - 1};
+        ::std::vector<Word> seeds(nbclusters * nbdims);
+        for (auto&& coord: seeds)
+            coord = coord_dist(engine);
+        for (size_t i = 0; i < points.size(); i += nbdims) {
+            auto cluster = cluster_dist(engine);
+            for (size_t d = 0; d < nbdims; ++d) {
+                points[i + d] = seeds[cluster * nbdims + d] + noise_dist(engine) - max_coord / 8;
+                totals[d] += points[i + d];
+            }
+        }
+    }
+private:
+    /** Get the address of the center coordinates, of the cluster counts and of the cluster coordinate sums.
+     * @return Address in shared memory
+    **/
+    Word* centers_addr() const noexcept {
+        return reinterpret_cast<Word*>(tm.get_start());
+    }
+    Word* counts_addr() const noexcept {
+        return centers_addr() + nbclusters * nbdims;
+    }
+    Word* sums_addr() const noexcept {
+        return counts_addr() + nbclusters;
+    }
+    /** Accumulation transaction, adding a point to the sums of a cluster.
+     * @param cluster Index of the cluster
+     * @param point   Coordinates of the point
+    **/
+    void accumulate_tx(size_t cluster, Word const* point) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Shared<Word> count{tx, counts_addr() + cluster};
+            count = count + 1;
+            Shared<Word[]> sums{tx, sums_addr() + cluster * nbdims};
+            for (size_t d = 0; d < nbdims; ++d)
+                sums.write(d, sums.read(d) + point[d]);
+        });
+    }
+    /** Center recomputation transaction, moving each center to the mean of its points and clearing the sums.
+     * @param nbaccumulated Number of points accumulated since the last recomputation
+     * @return Whether the sums account for every point exactly once
+    **/
+    bool recompute_tx(size_t nbaccumulated) const {
+        return transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Shared<Word[]> centers{tx, centers_addr()};
+            Shared<Word[]> counts{tx, counts_addr()};
+            Shared<Word[]> sums{tx, sums_addr()};
+            ::std::vector<Word> dim_totals(nbdims, 0);
+            size_t total = 0;
+            for (size_t c = 0; c < nbclusters; ++c) {
+                Word count = counts[c];
+                total += count;
+                for (size_t d = 0; d < nbdims; ++d) {
+                    Word sum = sums[c * nbdims + d];
+                    dim_totals[d] += sum;
+                    if (count > 0)
+                        centers.write(c * nbdims + d, sum / count);
+                    sums.write(c * nbdims + d, 0);
+                }
+                counts.write(c, 0);
+            }
+            return total == nbaccumulated && dim_totals == totals;
+        });
+    }
+    /** Read-only transaction, copying the centers.
+     * @param centers Buffer for the center coordinates, of each cluster
+    **/
+    void centers_tx(Word* centers) const {
+        transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            tx.read(centers_addr(), nbclusters * nbdims * sizeof(Word), centers);
+        });
+    }
+    /** Get the nearest center of a point.
+     * @param centers Center coordinates of each cluster
+     * @param point   Coordinates of the point
+     * @return Index of the nearest cluster
+    **/
+    size_t nearest(Word const* centers, Word const* point) const noexcept {
+        size_t res = 0;
+        auto best = ::std::numeric_limits<uint64_t>::max();
+        for (size_t c = 0; c < nbclusters; ++c) {
+            uint64_t dist = 0;
+            for (size_t d = 0; d < nbdims; ++d) {
+                auto delta = static_cast<int64_t>(centers[c * nbdims + d]) - static_cast<int64_t>(point[d]);
+                dist += static_cast<uint64_t>(delta * delta);
+            }
+            if (dist < best) {
+                best = dist;
+                res = c;
+            }
+        }
+        return res;
+    }
+    /** [thread-safe] One iteration: every worker accumulates its points, then the first worker recomputes the centers.
+     * @param uid     Unique ID of the worker
+     * @param centers Buffer for the center coordinates
+     * @param record  Whether to record the statistics of the transactions
+     * @return Whether the iteration checked out, for every worker
+    **/
+    bool iterate(Uid uid, Word* centers, bool record) const {
+        Chrono chrono;
+        transactional_pace();
+        chrono.start();
+        centers_tx(centers);
+        if (record)
+            stats.get(uid, kind_centers).record(chrono.delta(), transactional_retries);
+        auto const* point = points.data() + uid * nbpoints * nbdims;
+        for (size_t i = 0; i < nbpoints; ++i, point += nbdims) {
+            auto cluster = nearest(centers, point); // Local computation, outside of the transaction
+            transactional_pace();
+            chrono.start();
+            accumulate_tx(cluster, point);
+            if (record)
+                stats.get(uid, kind_accumulate).record(chrono.delta(), transactional_retries);
+        }
+        barrier.sync();
+        if (uid == 0) {
+            transactional_pace();
+            chrono.start();
+            if (unlikely(!recompute_tx(nbworkers * nbpoints)))
+                failed.store(true, ::std::memory_order_release);
+            if (record)
+                stats.get(uid, kind_recompute).record(chrono.delta(), transactional_retries);
+        }
+        barrier.sync();
+        return !failed.load(::std::memory_order_acquire);
+    }
+public:
+    virtual char const* init() const {
+        // Every worker runs the same initialization, the centers starting at the first points
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Shared<Word[]> centers{tx, centers_addr()};
+            Shared<Word[]> counts{tx, counts_addr()};
+            Shared<Word[]> sums{tx, sums_addr()};
+            for (size_t c = 0; c < nbclusters; ++c) {
+                for (size_t d = 0; d < nbdims; ++d) {
+                    centers.write(c * nbdims + d, points[(c * nbdims + d) % points.size()]);
+                    sums.write(c * nbdims + d, 0);
+                }
+                counts.write(c, 0);
+            }
+        });
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Shared<Word[]> centers{tx, centers_addr()};
+            return centers.read(0) == points[0];
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that committed writes in shared memory get visible to the following transactions' reads)";
+        return nullptr;
+    }
+    virtual char const* run(Uid uid, Seed seed [[gnu::unused]]) const {
+        ::std::vector<Word> centers(nbclusters * nbdims);
+        for (size_t iter = 0; iter < nbtxperwrk / nbpoints; ++iter) {
+            if (unlikely(!iterate(uid, centers.data(), true)))
+                return uid == 0 ? "Violated isolation or atomicity" : nullptr;
+        }
+        return nullptr;
+    }
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        ::std::vector<Word> centers(nbclusters * nbdims);
+        if (unlikely(!iterate(uid, centers.data(), false)))
+            return uid == 0 ? "Violated consistency, isolation or atomicity" : nullptr;
+        return nullptr;
+    }
+};
+
+/** Read-mostly configuration cache workload class.
+**/
+class WorkloadConfigCache final: public Workload {
+public:
+    /** Word class alias.
+    **/
+    using Word = uintptr_t;
+    /** Number of words per record, the first one being the version.
+    **/
+    constexpr static size_t record_words = 8;
+private:
+    /** Kinds of transaction, in the order given to the statistics.
+    **/
+    enum Kind: size_t {
+        kind_scan,
+        kind_update
+    };
+private:
+    size_t nbworkers;  // Number of concurrent workers
+    size_t nbtxperwrk; // Number of transactions per worker
+    size_t nbrecords;  // Number of records in the cache
+    size_t nbscanned;  // Number of consecutive records read per scan
+    size_t nbupdated;  // Number of records rewritten per update
+    float  prob_update; // Probability of an update
+    ::std::vector<Word> mutable updates; // Number of record updates committed by each worker, since the initialization
+    Barrier barrier;   // Barrier for thread synchronization during 'check'
+public:
+    /** Configuration cache workload constructor.
+     * @param library     Transactional library to use
+     * @param nbworkers   Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk  Number of transactions per worker
+     * @param size        Size of the cache (in bytes)
+     * @param nbscanned   Number of consecutive records read per scan
+     * @param nbupdated   Number of records rewritten per update
+     * @param prob_update Probability of an update
+    **/
+    WorkloadConfigCache(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, size_t size, size_t nbscanned, size_t nbupdated, float prob_update): Workload{library, alignof(Word), ::std::max<size_t>(1, size / (record_words * sizeof(Word))) * record_words * sizeof(Word), nbworkers, {"scan_tx", "update_tx"}}, nbworkers{nbworkers}, nbtxperwrk{nbtxperwrk}, nbrecords{::std::max<size_t>(1, size / (record_words * sizeof(Word)))}, nbscanned{::std::min(nbscanned, nbrecords)}, nbupdated{nbupdated}, prob_update{prob_update}, updates(nbworkers, 0), barrier{nbworkers} {}
+private:
+    /** Get the expected value of a record word.
+     * @param version Version of the record
+     * @param index   Index of the word in the record, the version excluded
+     * @return Expected value, all null for the initial (null) version
+    **/
+    static Word expected(Word version, size_t index) noexcept {
+        return version * (index + 1);
+    }
+    /** Read-only scan transaction, reading every word of consecutive records one by one.
+     * @param first Index of the first record, the scan wrapping around
+     * @return Whether every record read was consistent
+    **/
+    bool scan_tx(size_t first) const {
+        return transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Shared<Word[]> words{tx, tm.get_start()};
+            for (size_t i = 0; i < nbscanned; ++i) {
+                auto base = ((first + i) % nbrecords) * record_words;
+                Word version = words.read(base);
+                for (size_t j = 1; j < record_words; ++j) {
+                    if (unlikely(words.read(base + j) != expected(version, j - 1)))
+                        return false;
+                }
+            }
+            return true;
+        });
+    }
+    /** Update transaction, bumping the version of a few records and rewriting them.
+     * @param records Index of each record to update
+    **/
+    void update_tx(::std::vector<size_t> const& records) const {
+        transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+            Shared<Word[]> words{tx, tm.get_start()};
+            for (auto record: records) {
+                auto base = record * record_words;
+                Word version = words.read(base) + 1;
+                words.write(base, version);
+                for (size_t j = 1; j < record_words; ++j)
+                    words.write(base + j, expected(version, j - 1));
+            }
+        });
+    }
+public:
+    virtual char const* init() const {
+        // The shared memory region starts zeroed, i.e. every record at its consistent null version
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            Shared<Word[]> words{tx, tm.get_start()};
+            return words.read(0) == 0 && words.read((nbrecords - 1) * record_words + record_words - 1) == 0;
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that the shared memory region starts zeroed)";
+        return nullptr;
+    }
+    virtual char const* run(Uid uid, Seed seed) const {
+        ::std::minstd_rand engine{seed};
+        ::std::bernoulli_distribution update_dist{prob_update};
+        ::std::uniform_int_distribution<size_t> record_dist{0, nbrecords - 1};
+        ::std::vector<size_t> records(nbupdated);
+        Chrono chrono;
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            if (update_dist(engine)) { // Rare update
+                for (auto&& record: records)
+                    record = record_dist(engine);
+                transactional_pace();
+                chrono.start();
+                update_tx(records);
+                stats.get(uid, kind_update).record(chrono.delta(), transactional_retries);
+                updates[uid] += records.size();
+            } else { // Long read-only scan
+                auto first = record_dist(engine);
+                transactional_pace();
+                chrono.start();
+                auto correct = scan_tx(first);
+                stats.get(uid, kind_scan).record(chrono.delta(), transactional_retries);
+                if (unlikely(!correct))
+                    return "Violated isolation or atomicity";
+            }
+        }
+        return nullptr;
+    }
+    virtual char const* check(Uid uid, Seed seed [[gnu::unused]]) const {
+        barrier.sync();
+        if (uid != 0)
+            return nullptr;
+        // Every record consistent, and the versions adding up to the number of updates
+        Word expected_sum = 0;
+        for (auto count: updates)
+            expected_sum += count;
+        Word sum = 0;
+        for (size_t first = 0; first < nbrecords; first += nbscanned) { // In chunks, to bound the read sets
+            auto last = ::std::min(first + nbscanned, nbrecords);
+            auto chunk = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+                Shared<Word[]> words{tx, tm.get_start()};
+                auto res = ::std::make_pair(true, Word{0}); // Whether consistent, and the sum of the versions
+                for (auto record = first; record < last; ++record) {
+                    Word version = words.read(record * record_words);
+                    for (size_t j = 1; j < record_words; ++j) {
+                        if (unlikely(words.read(record * record_words + j) != expected(version, j - 1)))
+                            res.first = false;
+                    }
+                    res.second += version;
+                }
+                return res;
+            });
+            if (unlikely(!chunk.first))
+                return "Violated consistency, isolation or atomicity";
+            sum += chunk.second;
+        }
+        if (unlikely(sum != expected_sum))
+            return "Violated consistency, isolation or atomicity";
+        return nullptr;
+    }
+};
+
+/** Replay of a recorded trace workload class.
+**/
+class WorkloadReplay final: public Workload {
+public:
+    /** Word class alias.
+    **/
+    using Word = uintptr_t;
+private:
+    /** Kinds of transaction, in the order given to the statistics.
+    **/
+    enum Kind: size_t {
+        kind_ro,
+        kind_rw
+    };
+    /** Replay progress of one worker class.
+    **/
+    struct Cursor {
+        size_t pos; // Index of the begin operation of the next transaction in the stream
+        ::std::vector<void*> handles;   // Segment allocated by the committed transactions, by handle, 'nullptr' once freed
+        ::std::vector<void*> allocated; // Segments allocated by the current attempt
+        ::std::vector<size_t> freed;    // Handles freed by the current attempt
+        ::std::vector<Word> buffer;     // Private source and target of the accesses
+    };
+private:
+    TraceFile const& trace; // Trace to replay
+    size_t nbtxperwrk; // Number of transactions per worker
+    ::std::vector<Cursor> mutable cursors; // Progress of each worker, kept over the repetitions
+public:
+    /** Replay workload constructor.
+     * @param library    Transactional library to use
+     * @param nbworkers  Total number of concurrent threads (for both 'run' and 'check')
+     * @param nbtxperwrk Number of transactions per worker
+     * @param trace      Trace to replay, worker 'uid' replaying the stream of recorded thread 'uid' modulo their number
+    **/
+    WorkloadReplay(TransactionalLibrary const& library, size_t nbworkers, size_t nbtxperwrk, TraceFile const& trace): Workload{library, trace.get_align(), trace.get_size() + trace.get_folded(), nbworkers, {"replay_ro_tx", "replay_rw_tx"}}, trace{trace}, nbtxperwrk{nbtxperwrk}, cursors(nbworkers, Cursor{0, {}, {}, {}, {}}) {}
+private:
+    /** Resolve the first address of a run of accesses, or of a freed segment.
+     * @param cursor Progress of the calling worker
+     * @param op     Traced operation
+     * @param span   Number of bytes accessed from the resolved address
+     * @return Resolved address, 'nullptr' if the run does not fit in the folded granules
+    **/
+    void* resolve(Cursor const& cursor, TraceOp const& op, size_t span) const {
+        if (op.space == TraceOp::own) {
+            auto handle = static_cast<size_t>(op.offset >> 32);
+            void* segment = handle < cursor.handles.size() ? cursor.handles[handle] : (handle - cursor.handles.size() < cursor.allocated.size() ? cursor.allocated[handle - cursor.handles.size()] : nullptr);
+            if (likely(segment))
+                return reinterpret_cast<uint8_t*>(segment) + (op.offset & UINT32_MAX);
+        } else if (op.space == TraceOp::start) {
+            return reinterpret_cast<uint8_t*>(tm.get_start()) + op.offset;
+        }
+        // Segments allocated before the recording or by other threads were folded after the first segment, so was any freed handle
+        auto folded = trace.get_folded();
+        if (unlikely(span > folded))
+            return nullptr;
+        auto offset = (op.space == TraceOp::foreign ? op.offset : op.offset & UINT32_MAX) % (folded - span + 1);
+        return reinterpret_cast<uint8_t*>(tm.get_start()) + trace.get_size() + offset / tm.get_align() * tm.get_align();
+    }
+    /** Replay one recorded transaction.
+     * @param cursor Progress of the calling worker
+     * @param first  Begin operation of the transaction
+     * @param stamp  Value written in every word, changing from one transaction to the next
+     * @return Index of the end operation, relative to 'first'
+    **/
+    size_t replay_tx(Cursor& cursor, TraceOp const* first, Word stamp) const {
+        auto mode = first->kind == TraceOp::begin_ro ? Transaction::Mode::read_only : Transaction::Mode::read_write;
+        auto res = transactional(tm, mode, [&](Transaction& tx) {
+            cursor.allocated.clear();
+            cursor.freed.clear();
+            auto op = first + 1;
+            for (; op->kind != TraceOp::end; ++op) {
+                switch (op->kind) {
+                case TraceOp::read:
+                case TraceOp::write: {
+                    auto span = static_cast<size_t>(op->size) * op->count;
+                    auto target = reinterpret_cast<uint8_t*>(resolve(cursor, *op, span));
+                    if (unlikely(!target))
+                        break;
+                    auto nbwords = (op->size + sizeof(Word) - 1) / sizeof(Word);
+                    if (cursor.buffer.size() < nbwords)
+                        cursor.buffer.resize(nbwords);
+                    for (size_t i = 0; i < op->count; ++i) {
+                        if (op->kind == TraceOp::read) {
+                            tx.read(target + i * op->size, op->size, cursor.buffer.data());
+                        } else {
+                            ::std::fill_n(cursor.buffer.data(), nbwords, stamp);
+                            tx.write(cursor.buffer.data(), op->size, target + i * op->size);
+                        }
+                    }
+                } break;
+                case TraceOp::alloc:
+                    cursor.allocated.push_back(tx.alloc(op->size));
+                    break;
+                case TraceOp::free: { // Only the segments this worker allocated, the others stay allocated
+                    auto handle = static_cast<size_t>(op->offset >> 32);
+                    if (op->space != TraceOp::own || (op->offset & UINT32_MAX) != 0 || handle >= cursor.handles.size() || !cursor.handles[handle])
+                        break;
+                    tx.free(cursor.handles[handle]);
+                    cursor.freed.push_back(handle);
+                } break;
+                default:
+                    throw Exception::Unreachable{"transaction begin in the middle of a validated trace"};
+                }
+            }
+            return static_cast<size_t>(op - first);
+        });
+        cursor.handles.insert(cursor.handles.end(), cursor.allocated.begin(), cursor.allocated.end());
+        for (auto handle: cursor.freed)
+            cursor.handles[handle] = nullptr;
+        return res;
+    }
+    /** Free every segment still allocated by a worker, then forget their handles.
+     * @param cursor Progress of the calling worker
+    **/
+    void release(Cursor& cursor) const {
+        if (::std::any_of(cursor.handles.begin(), cursor.handles.end(), [](void* segment) { return segment != nullptr; })) {
+            transactional(tm, Transaction::Mode::read_write, [&](Transaction& tx) {
+                for (auto segment: cursor.handles) {
+                    if (segment)
+                        tx.free(segment);
+                }
+            });
+        }
+        cursor.handles.clear();
+    }
+public:
+    virtual char const* init() const {
+        // The shared memory region starts zeroed, as when it was recorded
+        auto correct = transactional(tm, Transaction::Mode::read_only, [&](Transaction& tx) {
+            ::std::vector<uint8_t> first(tm.get_align());
+            tx.read(tm.get_start(), first.size(), first.data());
+            return ::std::all_of(first.begin(), first.end(), [](uint8_t byte) { return byte == 0; });
+        });
+        if (unlikely(!correct))
+            return "Violated consistency (check that the shared memory region starts zeroed)";
+        return nullptr;
+    }
+    virtual char const* run(Uid uid, Seed seed [[gnu::unused]]) const {
+        auto const& stream = trace.get_stream(uid % trace.get_nbthreads());
+        if (stream.second == 0) // Recorded thread without any committed transaction
+            return nullptr;
+        auto& cursor = cursors[uid];
+        Chrono chrono;
+        for (size_t cntr = 0; cntr < nbtxperwrk; ++cntr) {
+            if (cursor.pos >= stream.second) { // Wrap around, with handles numbered from scratch as when recorded
+                cursor.pos = 0;
+                release(cursor);
+            }
+            auto first = stream.first + cursor.pos;
+            transactional_pace();
+            chrono.start();
+            cursor.pos += replay_tx(cursor, first, cntr * cursors.size() + uid + 1) + 1;
+            stats.get(uid, first->kind == TraceOp::begin_ro ? kind_ro : kind_rw).record(chrono.delta(), transactional_retries);
+        }
+        return nullptr;
+    }
+    virtual char const* check(Uid uid [[gnu::unused]], Seed seed [[gnu::unused]]) const {
+        // The replayed values carry no invariant, the recorded workload checked the library
+        return nullptr;
+    }
+};
@@ -0,0 +1,5 @@
+#!/bin/zsh
+set -e
+
+cd ..
+fd ".*\.(c|h)" include norec | xargs -I % sh -c "echo formatting %; clang-format -i %"
@@ -0,0 +1,76 @@
+#ifndef _LOG_H_
+#define _LOG_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Growable array of words, used for the segments allocated or freed by a
+ * transaction */
+typedef struct {
+  uintptr_t *items;
+  size_t count;
+  size_t cap;
+} vec_t;
+
+/* Read log: addresses of the words read and the values observed, one word of
+ * 'align' bytes per entry in 'data', used for value-based validation */
+typedef struct {
+  uintptr_t *addrs;
+  uint8_t *data;
+  size_t count;
+  size_t cap;
+  size_t align;
+} rlog_t;
+
+typedef struct {
+  uintptr_t addr; // Address of the written word in shared memory
+  size_t slot;    // Position of the entry in the lookup table
+} wentry_t;
+
+/* Redo log: written words in insertion order, their buffered values (one word
+ * of 'align' bytes per entry in 'data') and an open-addressing lookup table
+ * holding 'entry index + 1', 0 meaning an empty slot */
+typedef struct {
+  wentry_t *entries;
+  size_t count;
+  size_t cap;
+  size_t *table;
+  size_t table_cap;
+  uint8_t *data;
+  size_t align;
+} wlog_t;
+
+bool vec_push(vec_t *vec, uintptr_t item);
+
+void vec_clear(vec_t *vec);
+
+void vec_destroy(vec_t *vec);
+
+void rlog_init(rlog_t *log, size_t align);
+
+bool rlog_push(rlog_t *log, uintptr_t addr, void const *value);
+
+void rlog_clear(rlog_t *log);
+
+void rlog_destroy(rlog_t *log);
+
+void wlog_init(wlog_t *log, size_t align);
+
+void *wlog_lookup(wlog_t *log, uintptr_t addr);
+
+void *wlog_insert(wlog_t *log, uintptr_t addr);
+
+void wlog_clear(wlog_t *log);
+
+void wlog_destroy(wlog_t *log);
+
+static inline void *rlog_value(rlog_t *log, size_t index) {
+  return log->data + index * log->align;
+}
+
+static inline void *wlog_value(wlog_t *log, size_t index) {
+  return log->data + index * log->align;
+}
+
+#endif
@@ -0,0 +1,241 @@
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "common.h"
+#include "tm.h"
+
+// Ignore warnings from minunit header file
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#include "../template/minunit.h"
+#pragma GCC diagnostic pop
+
+void test_setup(void) {
+  // Do nothing
+}
+
+void test_teardown(void) {
+  // Do nothing
+}
+
+MU_TEST(test_mem_region) {
+  shared_t region_p = tm_create(120, 8);
+  {
+    mu_check(tm_size(region_p) == 120);
+    mu_check(tm_align(region_p) == 8);
+    mu_check((uintptr_t)tm_start(region_p) % 8 == 0);
+  }
+  tm_destroy(region_p);
+}
+
+MU_TEST(test_write_reflected_in_next_trans) {
+  shared_t region = tm_create(128, 1);
+  void *mem = tm_start(region);
+  void *mem1;
+
+  {
+    tx_t tx = tm_begin(region, false);
+    {
+      char target[9];
+
+      mu_check(tm_alloc(region, tx, 64, &mem1) == success_alloc);
+
+      mu_check(tm_write(region, tx, "some", 4, mem));
+      mu_check(tm_write(region, tx, "thing", 5, mem + 4));
+      mu_check(tm_read(region, tx, mem, 9, target));
+      mu_check(strncmp(target, "something", 9) == 0);
+
+      mu_check(tm_write(region, tx, "dirty seg", 9, mem1));
+      mu_check(tm_read(region, tx, mem1, 9, target));
+      mu_check(strncmp(target, "dirty seg", 9) == 0);
+    }
+    mu_check(tm_end(region, tx));
+
+    tx = tm_begin(region, true);
+    {
+      char target[9];
+
+      mu_check(tm_read(region, tx, mem, 9, target));
+      mu_check(strncmp(target, "something", 9) == 0);
+
+      mu_check(tm_read(region, tx, mem1, 9, target));
+      mu_check(strncmp(target, "dirty seg", 9) == 0);
+    }
+    mu_check(tm_end(region, tx));
+  }
+  tm_destroy(region);
+}
+
+MU_TEST(test_writes_invisible_before_commit) {
+  shared_t region = tm_create(64, 8);
+  uint64_t *mem = (uint64_t *)tm_start(region);
+  uint64_t value = 42, target;
+
+  tx_t tx = tm_begin(region, false);
+  mu_check(tm_write(region, tx, &value, sizeof(value), mem));
+  mu_check(*mem == 0);
+  mu_check(tm_end(region, tx));
+  mu_check(*mem == 42);
+  mu_check(((region_t *)region)->seq == 2);
+
+  tx = tm_begin(region, true);
+  mu_check(tm_read(region, tx, mem, sizeof(target), &target));
+  mu_check(target == 42);
+  mu_check(tm_end(region, tx));
+
+  tm_destroy(region);
+}
+
+MU_TEST(test_read_only_never_bumps_seq) {
+  shared_t region = tm_create(64, 8);
+  uint64_t *mem = (uint64_t *)tm_start(region);
+  uint64_t target;
+
+  tx_t tx = tm_begin(region, true);
+  mu_check(tm_read(region, tx, mem, sizeof(target), &target));
+  mu_check(tm_end(region, tx));
+
+  tx = tm_begin(region, false);
+  mu_check(tm_read(region, tx, mem, sizeof(target), &target));
+  mu_check(tm_end(region, tx));
+
+  mu_check(((region_t *)region)->seq == 0);
+  tm_destroy(region);
+}
+
+MU_TEST(test_unrelated_commit_does_not_abort) {
+  shared_t region = tm_create(64, 8);
+  uint64_t *mem = (uint64_t *)tm_start(region);
+  uint64_t value = 1, target;
+
+  tx_t reader = tm_begin(region, true);
+  mu_check(tm_read(region, reader, mem, sizeof(target), &target));
+
+  tx_t writer = tm_begin(region, false);
+  mu_check(tm_write(region, writer, &value, sizeof(value), mem + 1));
+  mu_check(tm_end(region, writer));
+
+  // The word already read still holds the same value
+  mu_check(tm_read(region, reader, mem + 2, sizeof(target), &target));
+  mu_check(tm_end(region, reader));
+
+  tm_destroy(region);
+}
+
+MU_TEST(test_stale_read_aborts) {
+  shared_t region = tm_create(64, 8);
+  uint64_t *mem = (uint64_t *)tm_start(region);
+  uint64_t value = 1, target;
+
+  tx_t reader = tm_begin(region, true);
+  mu_check(tm_read(region, reader, mem, sizeof(target), &target));
+
+  tx_t writer = tm_begin(region, false);
+  mu_check(tm_write(region, writer, &value, sizeof(value), mem));
+  mu_check(tm_end(region, writer));
+
+  // The word already read changed after the reader's snapshot
+  mu_check(!tm_read(region, reader, mem + 1, sizeof(target), &target));
+
+  tm_destroy(region);
+}
+
+MU_TEST(test_read_set_validated_at_commit) {
+  shared_t region = tm_create(64, 8);
+  uint64_t *mem = (uint64_t *)tm_start(region);
+  uint64_t value = 1, target;
+
+  tx_t tx = tm_begin(region, false);
+  mu_check(tm_read(region, tx, mem, sizeof(target), &target));
+  mu_check(tm_write(region, tx, &value, sizeof(value), mem + 1));
+
+  // Simulate a concurrent commit to the word already read
+  mem[0] = 7;
+  atomic_store(&((region_t *)region)->seq, (uintptr_t)2);
+
+  mu_check(!tm_end(region, tx));
+  mu_check(mem[1] == 0);
+
+  tm_destroy(region);
+}
+
+MU_TEST(test_free_recycles_segment) {
+  shared_t region = tm_create(64, 8);
+  void *mem1, *mem2;
+
+  tx_t tx = tm_begin(region, false);
+  mu_check(tm_alloc(region, tx, 64, &mem1) == success_alloc);
+  mu_check(tm_end(region, tx));
+
+  tx = tm_begin(region, false);
+  mu_check(tm_free(region, tx, mem1));
+  mu_check(tm_end(region, tx));
+
+  tx = tm_begin(region, false);
+  mu_check(tm_alloc(region, tx, 64, &mem2) == success_alloc);
+  mu_check(mem1 == mem2);
+  mu_check(tm_end(region, tx));
+
+  tm_destroy(region);
+}
+
+#define thread_count 4
+#define increments 1000
+
+static void *increment_runner(void *p) {
+  shared_t region = (shared_t)p;
+  uint64_t *counter = (uint64_t *)tm_start(region);
+
+  for (int i = 0; i < increments; i++) {
+    while (true) {
+      uint64_t value;
+      tx_t tx = tm_begin(region, false);
+      if (!tm_read(region, tx, counter, sizeof(value), &value))
+        continue;
+      value++;
+      if (!tm_write(region, tx, &value, sizeof(value), counter))
+        continue;
+      if (tm_end(region, tx))
+        break;
+    }
+  }
+  return NULL;
+}
+
+MU_TEST(test_concurrent_increments) {
+  shared_t region = tm_create(64, 8);
+  pthread_t threads[thread_count];
+
+  for (int i = 0; i < thread_count; i++)
+    pthread_create(&threads[i], NULL, increment_runner, region);
+  for (int i = 0; i < thread_count; i++)
+    pthread_join(threads[i], NULL);
+
+  mu_check(*(uint64_t *)tm_start(region) == thread_count * increments);
+  tm_destroy(region);
+}
+
+MU_TEST_SUITE(test_suite) {
+  MU_RUN_TEST(test_mem_region);
+  MU_RUN_TEST(test_write_reflected_in_next_trans);
+  MU_RUN_TEST(test_writes_invisible_before_commit);
+  MU_RUN_TEST(test_read_only_never_bumps_seq);
+  MU_RUN_TEST(test_unrelated_commit_does_not_abort);
+  MU_RUN_TEST(test_stale_read_aborts);
+  MU_RUN_TEST(test_read_set_validated_at_commit);
+  MU_RUN_TEST(test_free_recycles_segment);
+  MU_RUN_TEST(test_concurrent_increments);
+}
+
+int main() {
+  MU_SUITE_CONFIGURE(&test_setup, &test_teardown);
+
+  MU_RUN_SUITE(test_suite);
+  MU_REPORT();
+  return 0;
+}
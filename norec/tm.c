@@ -0,0 +1,354 @@
+#define _GNU_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#ifdef __STDC_NO_ATOMICS__
+#error Current C11 compiler does not support atomic operations
+#endif
+
+#include <assert.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "log.h"
+#include "tm.h"
+
+/* Transaction descriptors are pooled per thread and reused across
+ * transactions, so that the logs keep their grown capacity */
+static pthread_key_t pool_key;
+static pthread_once_t pool_key_once = PTHREAD_ONCE_INIT;
+
+static void pool_destroy(void *p) {
+  tx_desc_t *tx = (tx_desc_t *)p;
+  while (tx) {
+    tx_desc_t *next = tx->next_free;
+    rlog_destroy(&tx->reads);
+    wlog_destroy(&tx->writes);
+    vec_destroy(&tx->allocs);
+    vec_destroy(&tx->frees);
+    free(tx);
+    tx = next;
+  }
+}
+
+static void pool_key_create(void) {
+  assert(pthread_key_create(&pool_key, pool_destroy) == 0);
+}
+
+static tx_desc_t *desc_acquire(void) {
+  pthread_once(&pool_key_once, pool_key_create);
+  tx_desc_t *tx = (tx_desc_t *)pthread_getspecific(pool_key);
+  if (likely(tx)) {
+    pthread_setspecific(pool_key, tx->next_free);
+    return tx;
+  }
+  return (tx_desc_t *)calloc(1, sizeof(tx_desc_t));
+}
+
+static void desc_release(tx_desc_t *tx) {
+  tx->next_free = (tx_desc_t *)pthread_getspecific(pool_key);
+  if (unlikely(pthread_setspecific(pool_key, tx) != 0)) {
+    tx->next_free = NULL;
+    pool_destroy(tx);
+  }
+}
+
+/* Segments */
+
+static inline int size_class(size_t size) { return 63 - __builtin_clzl(size); }
+
+static inline seg_t *seg_of(region_t *region, void *data) {
+  return (seg_t *)((uintptr_t)data - region->delta_alloc);
+}
+
+static inline void *data_of(region_t *region, seg_t *seg) {
+  return (void *)((uintptr_t)seg + region->delta_alloc);
+}
+
+static seg_t *alloc_seg(region_t *region, size_t size) {
+  seg_t *seg = NULL;
+
+  // Segments are allocated at their exact size, so only reuse a freed one
+  // that is large enough
+  assert(pthread_mutex_lock(&region->seg_lock) == 0);
+  seg_t **link = &region->free_segs[size_class(size)];
+  while (*link) {
+    if ((*link)->capacity >= size) {
+      seg = *link;
+      *link = seg->next_free;
+      break;
+    }
+    link = &(*link)->next_free;
+  }
+  assert(pthread_mutex_unlock(&region->seg_lock) == 0);
+
+  if (!seg) {
+    if (unlikely(posix_memalign((void **)&seg, region->align_alloc,
+                                region->delta_alloc + size) != 0))
+      return NULL;
+    seg->capacity = size;
+    assert(pthread_mutex_lock(&region->seg_lock) == 0);
+    seg->next_all = region->segs;
+    region->segs = seg;
+    assert(pthread_mutex_unlock(&region->seg_lock) == 0);
+  }
+
+  seg->next_free = NULL;
+  seg->size = size;
+  memset(data_of(region, seg), 0, size);
+  return seg;
+}
+
+static void recycle_seg(region_t *region, seg_t *seg) {
+  assert(pthread_mutex_lock(&region->seg_lock) == 0);
+  seg_t **head = &region->free_segs[size_class(seg->capacity)];
+  seg->next_free = *head;
+  *head = seg;
+  assert(pthread_mutex_unlock(&region->seg_lock) == 0);
+}
+
+/* Transaction life cycle */
+
+static void tx_finish(tx_desc_t *tx) {
+  rlog_clear(&tx->reads);
+  wlog_clear(&tx->writes);
+  vec_clear(&tx->allocs);
+  vec_clear(&tx->frees);
+  desc_release(tx);
+}
+
+static void tx_abort(tx_desc_t *tx) {
+  if (DEBUG1)
+    printf("[%p] TX abort\n", (void *)tx);
+  for (size_t i = 0; i < tx->allocs.count; i++)
+    recycle_seg(tx->region, (seg_t *)tx->allocs.items[i]);
+  tx_finish(tx);
+}
+
+static inline uintptr_t wait_even(region_t *region) {
+  while (true) {
+    uintptr_t seq = atomic_load_explicit(&region->seq, memory_order_acquire);
+    if (likely(!(seq & 1)))
+      return seq;
+    sched_yield();
+  }
+}
+
+/* Value-based validation: wait for a quiescent sequence number, then check
+ * that every word read still holds the value observed.
+ * @return New snapshot on success, an odd value if the transaction must abort
+ */
+static uintptr_t validate(tx_desc_t *tx) {
+  region_t *region = tx->region;
+  size_t align = region->align;
+
+  while (true) {
+    uintptr_t time = wait_even(region);
+    for (size_t i = 0; i < tx->reads.count; i++) {
+      if (memcmp((void const *)tx->reads.addrs[i], rlog_value(&tx->reads, i),
+                 align) != 0)
+        return 1;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&region->seq, memory_order_relaxed) == time)
+      return time;
+  }
+}
+
+static bool tx_commit(tx_desc_t *tx) {
+  region_t *region = tx->region;
+
+  if (tx->writes.count == 0 && tx->frees.count == 0) {
+    // Every read was consistent with the snapshot when it happened
+    tx_finish(tx);
+    return true;
+  }
+
+  uintptr_t snapshot = tx->snapshot;
+  while (!atomic_compare_exchange_weak_explicit(&region->seq, &snapshot,
+                                                tx->snapshot + 1,
+                                                memory_order_acquire,
+                                                memory_order_relaxed)) {
+    snapshot = validate(tx);
+    if (unlikely(snapshot & 1)) {
+      tx_abort(tx);
+      return false;
+    }
+    tx->snapshot = snapshot;
+  }
+
+  for (size_t i = 0; i < tx->writes.count; i++)
+    memcpy((void *)tx->writes.entries[i].addr, wlog_value(&tx->writes, i),
+           region->align);
+  atomic_store_explicit(&region->seq, tx->snapshot + 2, memory_order_release);
+
+  for (size_t i = 0; i < tx->frees.count; i++)
+    recycle_seg(region, (seg_t *)tx->frees.items[i]);
+  tx_finish(tx);
+  return true;
+}
+
+/* Interface */
+
+shared_t tm_create(size_t size, size_t align) {
+  if (DEBUG1)
+    printf("TM create, size: %ld, align: %ld\n", size, align);
+  region_t *region = (region_t *)calloc(1, sizeof(region_t));
+  if (unlikely(!region))
+    return invalid_shared;
+
+  assert(pthread_mutex_init(&region->seg_lock, NULL) == 0);
+  atomic_init(&region->seq, 0);
+
+  // Also satisfy the alignment requirement of 'seg_t'
+  size_t align_alloc = align < sizeof(void *) ? sizeof(void *) : align;
+  region->size = size;
+  region->align = align;
+  region->align_alloc = align_alloc;
+  region->delta_alloc =
+      (sizeof(seg_t) + align_alloc - 1) / align_alloc * align_alloc;
+
+  seg_t *seg = alloc_seg(region, size);
+  if (unlikely(!seg)) {
+    free(region);
+    return invalid_shared;
+  }
+  region->start = data_of(region, seg);
+  return region;
+}
+
+void tm_destroy(shared_t shared) {
+  if (DEBUG1)
+    printf("TM destroy\n");
+  region_t *region = (region_t *)shared;
+  seg_t *seg = region->segs;
+  while (seg) {
+    seg_t *next = seg->next_all;
+    free(seg);
+    seg = next;
+  }
+  pthread_mutex_destroy(&region->seg_lock);
+  free(region);
+}
+
+void *tm_start(shared_t shared) { return ((region_t *)shared)->start; }
+
+size_t tm_size(shared_t shared) { return ((region_t *)shared)->size; }
+
+size_t tm_align(shared_t shared) { return ((region_t *)shared)->align; }
+
+tx_t tm_begin(shared_t shared, bool is_ro) {
+  region_t *region = (region_t *)shared;
+  tx_desc_t *tx = desc_acquire();
+  if (unlikely(!tx))
+    return invalid_tx;
+
+  if (unlikely(tx->writes.align != region->align)) {
+    rlog_destroy(&tx->reads);
+    rlog_init(&tx->reads, region->align);
+    wlog_destroy(&tx->writes);
+    wlog_init(&tx->writes, region->align);
+  }
+  tx->region = region;
+  tx->is_ro = is_ro;
+  tx->snapshot = wait_even(region);
+
+  if (DEBUG1)
+    printf("[%p] TM begin, snapshot: %lu\n", (void *)tx, tx->snapshot);
+  return (tx_t)tx;
+}
+
+bool tm_end(shared_t shared as(unused), tx_t tx) {
+  if (DEBUG1)
+    printf("[%lx] TM end\n", tx);
+  return tx_commit((tx_desc_t *)tx);
+}
+
+/* Unlocked read of one word, revalidating the read log until the value is
+ * known to be consistent with a snapshot */
+static inline bool read_word(tx_desc_t *tx, void const *source, void *target) {
+  region_t *region = tx->region;
+
+  memcpy(target, source, region->align);
+  atomic_thread_fence(memory_order_acquire);
+  while (atomic_load_explicit(&region->seq, memory_order_relaxed) !=
+         tx->snapshot) {
+    uintptr_t snapshot = validate(tx);
+    if (unlikely(snapshot & 1))
+      return false;
+    tx->snapshot = snapshot;
+    memcpy(target, source, region->align);
+    atomic_thread_fence(memory_order_acquire);
+  }
+  return rlog_push(&tx->reads, (uintptr_t)source, target);
+}
+
+bool tm_read(shared_t shared, tx_t tx_id, void const *source, size_t size,
+             void *target) {
+  region_t *region = (region_t *)shared;
+  tx_desc_t *tx = (tx_desc_t *)tx_id;
+  size_t align = region->align;
+
+  for (size_t offset = 0; offset < size; offset += align) {
+    uint8_t const *src = (uint8_t const *)source + offset;
+    uint8_t *dst = (uint8_t *)target + offset;
+
+    if (!tx->is_ro) {
+      void *value = wlog_lookup(&tx->writes, (uintptr_t)src);
+      if (value) {
+        memcpy(dst, value, align);
+        continue;
+      }
+    }
+    if (unlikely(!read_word(tx, src, dst))) {
+      tx_abort(tx);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool tm_write(shared_t shared, tx_t tx_id, void const *source, size_t size,
+              void *target) {
+  region_t *region = (region_t *)shared;
+  tx_desc_t *tx = (tx_desc_t *)tx_id;
+  size_t align = region->align;
+
+  for (size_t offset = 0; offset < size; offset += align) {
+    void *value = wlog_insert(&tx->writes, (uintptr_t)target + offset);
+    if (unlikely(!value)) {
+      tx_abort(tx);
+      return false;
+    }
+    memcpy(value, (uint8_t const *)source + offset, align);
+  }
+  return true;
+}
+
+alloc_t tm_alloc(shared_t shared, tx_t tx_id, size_t size, void **target) {
+  region_t *region = (region_t *)shared;
+  tx_desc_t *tx = (tx_desc_t *)tx_id;
+
+  seg_t *seg = alloc_seg(region, size);
+  if (unlikely(!seg))
+    return nomem_alloc;
+  if (unlikely(!vec_push(&tx->allocs, (uintptr_t)seg))) {
+    recycle_seg(region, seg);
+    return nomem_alloc;
+  }
+  *target = data_of(region, seg);
+  return success_alloc;
+}
+
+bool tm_free(shared_t shared, tx_t tx_id, void *target) {
+  region_t *region = (region_t *)shared;
+  tx_desc_t *tx = (tx_desc_t *)tx_id;
+
+  if (unlikely(!vec_push(&tx->frees, (uintptr_t)seg_of(region, target)))) {
+    tx_abort(tx);
+    return false;
+  }
+  return true;
+}
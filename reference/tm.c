@@ -25,7 +25,12 @@
 // #define USE_MM_PAUSE
 // #define USE_PTHREAD_LOCK
 // #define USE_TICKET_LOCK
+// #define USE_MCS_LOCK     // Queue lock, each waiter spinning on its own node
+// #define USE_COHORT_LOCK  // NUMA-aware cohort lock: global ticket lock handed over within per-node MCS queues
+// #define USE_BRAVO_LOCK   // Reader-writer lock with a fast path for readers through per-thread indicators
 #define USE_RW_LOCK
+// #define USE_STRIPED_LOCK // Address-striped reader-writer locks instead of one global lock per transaction
+// #define USE_SEQLOCK_READS // Read-only transactions run without locking, validated against a sequence number
 
 // Requested features
 #define _GNU_SOURCE
@@ -36,19 +41,23 @@
 
 // External headers
 #include <pthread.h>
+#include <sched.h>
 #include <stdatomic.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #if (defined(__i386__) || defined(__x86_64__)) && defined(USE_MM_PAUSE)
     #include <xmmintrin.h>
-#else
-    #include <sched.h>
 #endif
 
 // Internal headers
 #include <tm.h>
 
+#if defined(USE_STRIPED_LOCK) && defined(USE_SEQLOCK_READS)
+    #error USE_SEQLOCK_READS requires the global lock, it cannot be combined with USE_STRIPED_LOCK
+#endif
+
 // -------------------------------------------------------------------------- //
 
 /** Define a proposition as likely true.
@@ -151,6 +160,12 @@ struct lock_t {
     pthread_mutex_t mutex;
 };
 
+/** Holder state, none for this lock.
+**/
+struct lock_node {
+    char unused;
+};
+
 /** Initialize the given lock.
  * @param lock Lock to initialize
  * @return Whether the operation is a success
@@ -168,27 +183,33 @@ static void lock_cleanup(struct lock_t* lock) {
 
 /** Wait and acquire the given lock.
  * @param lock Lock to acquire
+ * @param node Holder state of the caller
  * @return Whether the operation is a success
 **/
-static bool lock_acquire(struct lock_t* lock) {
+static bool lock_acquire(struct lock_t* lock, struct lock_node* node as(unused)) {
     return pthread_mutex_lock(&(lock->mutex)) == 0;
 }
 
 /** Release the given lock.
  * @param lock Lock to release
+ * @param node Holder state of the caller
 **/
-static void lock_release(struct lock_t* lock) {
+static void lock_release(struct lock_t* lock, struct lock_node* node as(unused)) {
     pthread_mutex_unlock(&(lock->mutex));
 }
 
-static bool lock_acquire_shared(struct lock_t* lock) {
-    return lock_acquire(lock);
+#if !defined(USE_STRIPED_LOCK) // Striped transactions only take the region lock exclusively
+
+static bool lock_acquire_shared(struct lock_t* lock, struct lock_node* node) {
+    return lock_acquire(lock, node);
 }
 
-static void lock_release_shared(struct lock_t* lock) {
-    lock_release(lock);
+static void lock_release_shared(struct lock_t* lock, struct lock_node* node) {
+    lock_release(lock, node);
 }
 
+#endif
+
 #elif defined(USE_TICKET_LOCK)
 
 struct lock_t {
@@ -196,6 +217,12 @@ struct lock_t {
     atomic_ulong take; // Ticket the next thread takes
 };
 
+/** Holder state, none for this lock.
+**/
+struct lock_node {
+    char unused;
+};
+
 /** Initialize the given lock.
  * @param lock Lock to initialize
  * @return Whether the operation is a success
@@ -215,9 +242,10 @@ static void lock_cleanup(struct lock_t* lock as(unused)) {
 
 /** Wait and acquire the given lock.
  * @param lock Lock to acquire
+ * @param node Holder state of the caller
  * @return Whether the operation is a success
 **/
-static bool lock_acquire(struct lock_t* lock) {
+static bool lock_acquire(struct lock_t* lock, struct lock_node* node as(unused)) {
     unsigned long ticket = atomic_fetch_add_explicit(&(lock->take), 1ul, memory_order_relaxed);
     while (atomic_load_explicit(&(lock->pass), memory_order_relaxed) != ticket)
         pause();
@@ -227,25 +255,367 @@ static bool lock_acquire(struct lock_t* lock) {
 
 /** Release the given lock.
  * @param lock Lock to release
+ * @param node Holder state of the caller
 **/
-static void lock_release(struct lock_t* lock) {
+static void lock_release(struct lock_t* lock, struct lock_node* node as(unused)) {
     atomic_fetch_add_explicit(&(lock->pass), 1, memory_order_release);
 }
 
-static bool lock_acquire_shared(struct lock_t* lock) {
-    return lock_acquire(lock);
+#if !defined(USE_STRIPED_LOCK) // Striped transactions only take the region lock exclusively
+
+static bool lock_acquire_shared(struct lock_t* lock, struct lock_node* node) {
+    return lock_acquire(lock, node);
+}
+
+static void lock_release_shared(struct lock_t* lock, struct lock_node* node) {
+    lock_release(lock, node);
+}
+
+#endif
+
+#elif defined(USE_MCS_LOCK)
+
+/** Holder state: the queue node, one per acquisition since a thread may hold several locks at once.
+**/
+struct lock_node {
+    _Atomic(struct lock_node*) next;   // Successor in the queue
+    atomic_bool                locked; // Whether the owner must keep waiting
+} as(aligned(64));
+
+struct lock_t {
+    _Atomic(struct lock_node*) tail; // Last node in the queue, 'NULL' if free
+};
+
+/** Initialize the given lock.
+ * @param lock Lock to initialize
+ * @return Whether the operation is a success
+**/
+static bool lock_init(struct lock_t* lock) {
+    atomic_init(&(lock->tail), NULL);
+    return true;
+}
+
+/** Clean the given lock up.
+ * @param lock Lock to clean up
+**/
+static void lock_cleanup(struct lock_t* lock as(unused)) {
+    return;
+}
+
+/** Wait and acquire the given lock.
+ * @param lock Lock to acquire
+ * @param node Holder state of the caller
+ * @return Whether the operation is a success
+**/
+static bool lock_acquire(struct lock_t* lock, struct lock_node* node) {
+    atomic_store_explicit(&(node->next), NULL, memory_order_relaxed);
+    atomic_store_explicit(&(node->locked), true, memory_order_relaxed);
+    struct lock_node* pred = atomic_exchange_explicit(&(lock->tail), node, memory_order_acq_rel);
+    if (pred) {
+        atomic_store_explicit(&(pred->next), node, memory_order_release);
+        while (atomic_load_explicit(&(node->locked), memory_order_acquire)) // Spin on our own cache line only
+            pause();
+    }
+    return true;
+}
+
+/** Release the given lock.
+ * @param lock Lock to release
+ * @param node Holder state of the caller
+**/
+static void lock_release(struct lock_t* lock, struct lock_node* node) {
+    struct lock_node* next = atomic_load_explicit(&(node->next), memory_order_acquire);
+    if (!next) {
+        struct lock_node* expected = node;
+        if (atomic_compare_exchange_strong_explicit(&(lock->tail), &expected, NULL, memory_order_release, memory_order_relaxed))
+            return;
+        while (!(next = atomic_load_explicit(&(node->next), memory_order_acquire))) // Successor is linking itself
+            pause();
+    }
+    atomic_store_explicit(&(next->locked), false, memory_order_release);
+}
+
+#if !defined(USE_STRIPED_LOCK) // Striped transactions only take the region lock exclusively
+
+static bool lock_acquire_shared(struct lock_t* lock, struct lock_node* node) {
+    return lock_acquire(lock, node);
+}
+
+static void lock_release_shared(struct lock_t* lock, struct lock_node* node) {
+    lock_release(lock, node);
+}
+
+#endif
+
+#elif defined(USE_COHORT_LOCK)
+
+#define COHORT_NB_NODES 8  // Maximum number of NUMA nodes told apart
+#define COHORT_PASSES   64 // Maximum number of consecutive hand-overs within a node
+
+enum cohort_state {
+    cohort_wait,   // Waiting for the predecessor in the node queue
+    cohort_passed, // Predecessor handed over the global lock
+    cohort_global  // Predecessor released the global lock, must acquire it
+};
+
+/** Holder state: the node queue entry, one per acquisition since a thread may hold several locks at once.
+**/
+struct lock_node {
+    _Atomic(struct lock_node*) next;  // Successor in the node queue
+    atomic_int                 state; // 'enum cohort_state'
+    unsigned int               numa;  // Node queue used by the current acquisition
+} as(aligned(64));
+
+struct lock_t {
+    struct {
+        atomic_ulong pass; // Ticket that acquires the lock
+        atomic_ulong take; // Ticket the next cohort takes
+        char padding[64 - 2 * sizeof(atomic_ulong)];
+    } global;
+    struct {
+        _Atomic(struct lock_node*) tail; // Last entry in the node queue, 'NULL' if free
+        unsigned long passes;            // Consecutive hand-overs (only accessed by the owner)
+        char padding[64 - sizeof(void*) - sizeof(unsigned long)];
+    } local[COHORT_NB_NODES]; // One cache line per node queue
+};
+
+/** Get the NUMA node of the calling thread.
+ * @return NUMA node index (modulo 'COHORT_NB_NODES')
+**/
+static unsigned int cohort_current_numa() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+    unsigned int cpu, node;
+    if (likely(getcpu(&cpu, &node) == 0))
+        return node % COHORT_NB_NODES;
+#endif
+    return 0;
+}
+
+/** Initialize the given lock.
+ * @param lock Lock to initialize
+ * @return Whether the operation is a success
+**/
+static bool lock_init(struct lock_t* lock) {
+    atomic_init(&(lock->global.pass), 0ul);
+    atomic_init(&(lock->global.take), 0ul);
+    for (unsigned int i = 0; i < COHORT_NB_NODES; ++i) {
+        atomic_init(&(lock->local[i].tail), NULL);
+        lock->local[i].passes = 0;
+    }
+    return true;
+}
+
+/** Clean the given lock up.
+ * @param lock Lock to clean up
+**/
+static void lock_cleanup(struct lock_t* lock as(unused)) {
+    return;
+}
+
+/** Wait and acquire the given lock: first the node-local queue, then the global lock unless handed over.
+ * @param lock Lock to acquire
+ * @param node Holder state of the caller
+ * @return Whether the operation is a success
+**/
+static bool lock_acquire(struct lock_t* lock, struct lock_node* node) {
+    unsigned int numa = cohort_current_numa();
+    node->numa = numa; // The thread may migrate before releasing
+    atomic_store_explicit(&(node->next), NULL, memory_order_relaxed);
+    atomic_store_explicit(&(node->state), cohort_wait, memory_order_relaxed);
+    struct lock_node* pred = atomic_exchange_explicit(&(lock->local[numa].tail), node, memory_order_acq_rel);
+    if (pred) {
+        atomic_store_explicit(&(pred->next), node, memory_order_release);
+        int state;
+        while ((state = atomic_load_explicit(&(node->state), memory_order_acquire)) == cohort_wait)
+            pause();
+        if (state == cohort_passed)
+            return true;
+    }
+    unsigned long ticket = atomic_fetch_add_explicit(&(lock->global.take), 1ul, memory_order_relaxed);
+    while (atomic_load_explicit(&(lock->global.pass), memory_order_relaxed) != ticket)
+        pause();
+    atomic_thread_fence(memory_order_acquire);
+    lock->local[numa].passes = 0;
+    return true;
+}
+
+/** Release the given lock, handing the global lock over to the next waiter of the same node if allowed.
+ * @param lock Lock to release
+ * @param node Holder state of the caller
+**/
+static void lock_release(struct lock_t* lock, struct lock_node* node) {
+    unsigned int numa = node->numa;
+    struct lock_node* next = atomic_load_explicit(&(node->next), memory_order_acquire);
+    if (!next) {
+        struct lock_node* expected = node;
+        if (atomic_compare_exchange_strong_explicit(&(lock->local[numa].tail), &expected, NULL, memory_order_release, memory_order_relaxed)) {
+            atomic_fetch_add_explicit(&(lock->global.pass), 1ul, memory_order_release);
+            return;
+        }
+        while (!(next = atomic_load_explicit(&(node->next), memory_order_acquire))) // Successor is linking itself
+            pause();
+    }
+    if (lock->local[numa].passes < COHORT_PASSES) { // Keep the global lock within the node
+        ++lock->local[numa].passes;
+        atomic_store_explicit(&(next->state), cohort_passed, memory_order_release);
+    } else { // Let the other nodes in
+        atomic_fetch_add_explicit(&(lock->global.pass), 1ul, memory_order_release);
+        atomic_store_explicit(&(next->state), cohort_global, memory_order_release);
+    }
+}
+
+#if !defined(USE_STRIPED_LOCK) // Striped transactions only take the region lock exclusively
+
+static bool lock_acquire_shared(struct lock_t* lock, struct lock_node* node) {
+    return lock_acquire(lock, node);
+}
+
+static void lock_release_shared(struct lock_t* lock, struct lock_node* node) {
+    lock_release(lock, node);
+}
+
+#endif
+
+#elif defined(USE_BRAVO_LOCK)
+
+#define BRAVO_NB_SLOTS 4096 // Number of reader indicators, shared by every lock
+#define BRAVO_INHIBIT  9    // How many times the revocation cost to keep the readers' fast path disabled
+
+/** Visible readers table: a reader on the fast path publishes the address of the lock it holds in one slot,
+ * so that readers only touch their own slot and writers pay for scanning the table instead.
+**/
+static atomic_uintptr_t bravo_readers[BRAVO_NB_SLOTS];
+
+struct lock_t {
+    pthread_rwlock_t rwlock;    // Underlying lock, for writers and the readers' slow path
+    atomic_bool      rbias;     // Whether readers may take the fast path
+    atomic_ulong     inhibit;   // Time until which the fast path stays disabled after a revocation (in ns)
+};
+
+/** Holder state, kept per acquisition since a thread may read-hold several locks at once.
+**/
+struct lock_node {
+    atomic_uintptr_t* slot; // Slot taken by a fast-path read acquisition, 'NULL' if on the slow path
+};
+
+/** Get the current monotonic time.
+ * @return Time (in ns)
+**/
+static unsigned long bravo_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long) ts.tv_sec * 1000000000ul + (unsigned long) ts.tv_nsec;
+}
+
+/** Initialize the given lock.
+ * @param lock Lock to initialize
+ * @return Whether the operation is a success
+**/
+static bool lock_init(struct lock_t* lock) {
+    atomic_init(&(lock->rbias), true);
+    atomic_init(&(lock->inhibit), 0ul);
+    return (0 == pthread_rwlock_init(&lock->rwlock, NULL));
+}
+
+/** Clean the given lock up.
+ * @param lock Lock to clean up
+**/
+static void lock_cleanup(struct lock_t* lock) {
+    pthread_rwlock_destroy(&lock->rwlock);
+}
+
+/** Wait and acquire the given lock, revoking the readers' fast path and waiting for its readers to leave.
+ * @param lock Lock to acquire
+ * @param node Holder state of the caller
+ * @return Whether the operation is a success
+**/
+static bool lock_acquire(struct lock_t* lock, struct lock_node* node as(unused)) {
+    if (unlikely(0 != pthread_rwlock_wrlock(&lock->rwlock)))
+        return false;
+    if (atomic_load_explicit(&(lock->rbias), memory_order_relaxed)) {
+        atomic_store(&(lock->rbias), false);
+        atomic_thread_fence(memory_order_seq_cst); // Order the revocation before the scan, pairs with the readers' publication
+        unsigned long start = bravo_now();
+        for (size_t i = 0; i < BRAVO_NB_SLOTS; ++i) {
+            while (atomic_load_explicit(&(bravo_readers[i]), memory_order_acquire) == (uintptr_t) lock)
+                pause();
+        }
+        unsigned long now = bravo_now();
+        atomic_store_explicit(&(lock->inhibit), now + (now - start) * BRAVO_INHIBIT, memory_order_relaxed);
+    }
+    return true;
+}
+
+/** Release the given lock.
+ * @param lock Lock to release
+ * @param node Holder state of the caller
+**/
+static void lock_release(struct lock_t* lock, struct lock_node* node as(unused)) {
+    pthread_rwlock_unlock(&lock->rwlock);
+}
+
+#if !defined(USE_STRIPED_LOCK) // Striped transactions only take the region lock exclusively
+
+/** Get the reader indicator of the calling thread for the given lock.
+ * @param lock Lock to read-acquire
+ * @return Reader indicator
+**/
+static atomic_uintptr_t* bravo_slot_of(struct lock_t* lock) {
+    uintptr_t hash = ((uintptr_t) pthread_self() ^ ((uintptr_t) lock >> 6)) * UINT64_C(0x9E3779B97F4A7C15);
+    return &(bravo_readers[(hash >> 32) % BRAVO_NB_SLOTS]);
 }
 
-static void lock_release_shared(struct lock_t* lock) {
-    lock_release(lock);
+/** Wait and acquire the given lock in shared mode, through the calling thread's reader indicator if possible.
+ * @param lock Lock to acquire
+ * @param node Holder state of the caller
+ * @return Whether the operation is a success
+**/
+static bool lock_acquire_shared(struct lock_t* lock, struct lock_node* node) {
+    if (likely(atomic_load_explicit(&(lock->rbias), memory_order_relaxed))) {
+        atomic_uintptr_t* slot = bravo_slot_of(lock);
+        uintptr_t expected = 0;
+        if (likely(atomic_compare_exchange_strong(slot, &expected, (uintptr_t) lock))) {
+            if (likely(atomic_load(&(lock->rbias)))) { // Checked after publication, so a writer either sees the slot or we see the revocation
+                node->slot = slot;
+                return true;
+            }
+            atomic_store_explicit(slot, 0, memory_order_release);
+        }
+    }
+    if (unlikely(0 != pthread_rwlock_rdlock(&lock->rwlock)))
+        return false;
+    node->slot = NULL;
+    if (!atomic_load_explicit(&(lock->rbias), memory_order_relaxed) && bravo_now() >= atomic_load_explicit(&(lock->inhibit), memory_order_relaxed))
+        atomic_store_explicit(&(lock->rbias), true, memory_order_relaxed); // No writer can be revoking while the lock is read-held
+    return true;
 }
 
+/** Release the given lock from shared mode.
+ * @param lock Lock to release
+ * @param node Holder state of the caller
+**/
+static void lock_release_shared(struct lock_t* lock, struct lock_node* node) {
+    if (node->slot) {
+        atomic_store_explicit(node->slot, 0, memory_order_release);
+    } else {
+        pthread_rwlock_unlock(&lock->rwlock);
+    }
+}
+
+#endif
+
 #elif defined(USE_RW_LOCK)
 
 struct lock_t {
     pthread_rwlock_t rwlock;
 };
 
+/** Holder state, none for this lock.
+**/
+struct lock_node {
+    char unused;
+};
+
 /** Initialize the given lock.
  * @param lock Lock to initialize
  * @return Whether the operation is a success
@@ -263,40 +633,54 @@ static void lock_cleanup(struct lock_t* lock as(unused)) {
 
 /** Wait and acquire the given lock.
  * @param lock Lock to acquire
+ * @param node Holder state of the caller
  * @return Whether the operation is a success
 **/
-static bool lock_acquire(struct lock_t* lock) {
+static bool lock_acquire(struct lock_t* lock, struct lock_node* node as(unused)) {
     return (0 == pthread_rwlock_wrlock(&lock->rwlock));
 }
 
 /** Release the given lock.
  * @param lock Lock to release
+ * @param node Holder state of the caller
 **/
-static void lock_release(struct lock_t* lock) {
+static void lock_release(struct lock_t* lock, struct lock_node* node as(unused)) {
     pthread_rwlock_unlock(&lock->rwlock);
 }
 
+#if !defined(USE_STRIPED_LOCK) // Striped transactions only take the region lock exclusively
+
 /** Wait and acquire the given lock.
  * @param lock Lock to acquire
+ * @param node Holder state of the caller
  * @return Whether the operation is a success
 **/
-static bool lock_acquire_shared(struct lock_t* lock) {
+static bool lock_acquire_shared(struct lock_t* lock, struct lock_node* node as(unused)) {
     return (0 == pthread_rwlock_rdlock(&lock->rwlock));
 }
 
 /** Release the given lock.
  * @param lock Lock to release
+ * @param node Holder state of the caller
 **/
-static void lock_release_shared(struct lock_t* lock) {
+static void lock_release_shared(struct lock_t* lock, struct lock_node* node as(unused)) {
     pthread_rwlock_unlock(&lock->rwlock);
 }
 
+#endif
+
 #else // Test-and-test-and-set
 
 struct lock_t {
     atomic_bool locked; // Whether the lock is taken
 };
 
+/** Holder state, none for this lock.
+**/
+struct lock_node {
+    char unused;
+};
+
 /** Initialize the given lock.
  * @param lock Lock to initialize
  * @return Whether the operation is a success
@@ -315,9 +699,10 @@ static void lock_cleanup(struct lock_t* lock as(unused)) {
 
 /** Wait and acquire the given lock.
  * @param lock Lock to acquire
+ * @param node Holder state of the caller
  * @return Whether the operation is a success
 **/
-static bool lock_acquire(struct lock_t* lock) {
+static bool lock_acquire(struct lock_t* lock, struct lock_node* node as(unused)) {
     bool expected = false;
     while (unlikely(!atomic_compare_exchange_weak_explicit(&(lock->locked), &expected, true, memory_order_acquire, memory_order_relaxed))) {
         expected = false;
@@ -329,25 +714,267 @@ static bool lock_acquire(struct lock_t* lock) {
 
 /** Release the given lock.
  * @param lock Lock to release
+ * @param node Holder state of the caller
 **/
-static void lock_release(struct lock_t* lock) {
+static void lock_release(struct lock_t* lock, struct lock_node* node as(unused)) {
     atomic_store_explicit(&(lock->locked), false, memory_order_release);
 }
 
-static bool lock_acquire_shared(struct lock_t* lock) {
-    return lock_acquire(lock);
+#if !defined(USE_STRIPED_LOCK) // Striped transactions only take the region lock exclusively
+
+static bool lock_acquire_shared(struct lock_t* lock, struct lock_node* node) {
+    return lock_acquire(lock, node);
 }
 
-static void lock_release_shared(struct lock_t* lock) {
-    lock_release(lock);
+static void lock_release_shared(struct lock_t* lock, struct lock_node* node) {
+    lock_release(lock, node);
 }
 
 #endif
 
+#endif
+
 // -------------------------------------------------------------------------- //
 
-static const tx_t read_only_ref_tx  = UINTPTR_MAX - 10;
-static const tx_t read_write_tx = UINTPTR_MAX - 11;
+#if defined(USE_STRIPED_LOCK)
+
+#define NB_STRIPES   1024 // Number of address stripes
+#define STRIPE_GRAIN 64   // Bytes covered by one stripe (cache line)
+#define STRIPE_SPINS 64   // Pauses of a stripe wait before yielding the processor to a possibly descheduled holder
+
+/** Reader-writer spin lock protecting one address stripe.
+**/
+struct stripe {
+    atomic_long state; // Number of readers, or -1 when held exclusively
+    char padding[64 - sizeof(atomic_long)]; // One stripe per cache line
+};
+
+/** Wait for a held stripe, pausing a bounded number of times before yielding the processor to its holder.
+ * @param spins Number of pauses of the current wait so far
+ * @param block Whether to wait at all, out-of-order acquisitions fail at once and yield only after releasing their stripes (see 'tx_abort')
+ * @return Whether to try the stripe again, the acquisition must fail otherwise
+**/
+static inline bool stripe_wait(unsigned int* spins, bool block) {
+    if (!block)
+        return false;
+    if (*spins < STRIPE_SPINS) {
+        ++*spins;
+        pause();
+    } else {
+        sched_yield();
+    }
+    return true;
+}
+
+/** Try to acquire the given stripe in shared mode.
+ * @param stripe Stripe to acquire
+ * @param block  Whether to wait for a writer to leave
+ * @return Whether the stripe was acquired
+**/
+static bool stripe_acquire_shared(struct stripe* stripe, bool block) {
+    unsigned int spins = 0;
+    while (true) {
+        long state = atomic_load_explicit(&(stripe->state), memory_order_relaxed);
+        if (likely(state >= 0)) {
+            if (likely(atomic_compare_exchange_weak_explicit(&(stripe->state), &state, state + 1, memory_order_acquire, memory_order_relaxed)))
+                return true;
+            continue;
+        }
+        if (!stripe_wait(&spins, block))
+            return false;
+    }
+}
+
+/** Try to acquire the given stripe in exclusive mode.
+ * @param stripe Stripe to acquire
+ * @param block  Whether to wait for the readers and writer to leave
+ * @return Whether the stripe was acquired
+**/
+static bool stripe_acquire(struct stripe* stripe, bool block) {
+    unsigned int spins = 0;
+    while (true) {
+        long state = 0;
+        if (likely(atomic_compare_exchange_weak_explicit(&(stripe->state), &state, -1l, memory_order_acquire, memory_order_relaxed)))
+            return true;
+        if (state != 0 && !stripe_wait(&spins, block))
+            return false;
+    }
+}
+
+/** Release the given stripe.
+ * @param stripe Stripe to release
+ * @param shared Whether the stripe was held in shared mode
+**/
+static void stripe_release(struct stripe* stripe, bool shared) {
+    if (shared) {
+        atomic_fetch_sub_explicit(&(stripe->state), 1l, memory_order_release);
+    } else {
+        atomic_store_explicit(&(stripe->state), 0l, memory_order_release);
+    }
+}
+
+enum stripe_mode {
+    stripe_none = 0,
+    stripe_shared,
+    stripe_exclusive
+};
+
+/** Undo log entry, the previous content is stored in the transaction's undo buffer.
+**/
+struct undo {
+    void*  target; // Overwritten address in shared memory
+    size_t size;   // Overwritten size (in bytes)
+    size_t offset; // Offset of the previous content in the undo buffer
+};
+
+/** Growable byte array.
+**/
+struct array {
+    void*  data; // Content
+    size_t size; // Bytes in use
+    size_t cap;  // Capacity (in bytes)
+};
+
+/** Append bytes at the end of an array.
+ * @param array Array to grow
+ * @param size  Number of bytes to append
+ * @return Address of the appended (uninitialized) bytes, 'NULL' on allocation failure
+**/
+static void* array_append(struct array* array, size_t size) {
+    if (unlikely(array->size + size > array->cap)) {
+        size_t cap = array->cap == 0 ? 256 : array->cap;
+        while (cap < array->size + size)
+            cap *= 2;
+        void* data = realloc(array->data, cap);
+        if (unlikely(!data))
+            return NULL;
+        array->data = data;
+        array->cap  = cap;
+    }
+    void* res = (void*) ((uintptr_t) array->data + array->size);
+    array->size += size;
+    return res;
+}
+
+/** Append an element at the end of an array.
+ * @param array Array to grow
+ * @param type  Element type
+ * @param value Element value
+ * @return Whether the operation is a success
+**/
+#define array_push(array, type, value) \
+    ({ \
+        type* _slot = (type*) array_append((array), sizeof(type)); \
+        if (likely(_slot)) \
+            *_slot = (value); \
+        _slot != NULL; \
+    })
+
+/** Iterate over the elements of an array.
+ * @param array Array to iterate
+ * @param type  Element type
+ * @param name  Element pointer name
+**/
+#define array_foreach(array, type, name) \
+    for (type* name = (type*) (array)->data; name < (type*) ((uintptr_t) (array)->data + (array)->size); ++name)
+
+/** Get the stripe index of an address.
+ * @param addr Address in shared memory
+ * @return Stripe index
+**/
+static inline size_t stripe_of(void const* addr) {
+    return ((uintptr_t) addr / STRIPE_GRAIN) % NB_STRIPES;
+}
+
+#endif
+
+// -------------------------------------------------------------------------- //
+
+/** Transaction descriptor, pooled per thread so that its logs keep their grown capacity.
+**/
+struct transaction {
+    struct transaction* next_free; // Next descriptor in the thread's pool
+    bool   is_ro;          // Whether the transaction is read-only
+    struct lock_node node; // Holder state of the region's lock (which only guards the allocated segments with USE_STRIPED_LOCK)
+#if defined(USE_SEQLOCK_READS)
+    bool          locked; // Whether the transaction holds the lock, i.e. is not an optimistic read-only transaction
+    unsigned long seq;    // Sequence number the optimistic read-only transaction started at
+#endif
+#if defined(USE_STRIPED_LOCK)
+    size_t next_stripe;  // Lowest stripe index that can be waited for without breaking the canonical order
+    struct array held;   // Indices of the stripes held ('size_t')
+    struct array undo;   // Undo log ('struct undo')
+    struct array olds;   // Undo buffer (previous contents)
+    struct array allocs; // Segments allocated, freed on abort ('struct link*')
+    struct array frees;  // Segments freed, freed on commit ('struct link*')
+    unsigned char modes[NB_STRIPES]; // Mode in which each stripe is held ('enum stripe_mode')
+#endif
+};
+
+static _Thread_local struct transaction* tx_pool = NULL; // Descriptors of the calling thread not in use
+static pthread_key_t  tx_pool_key;                       // Frees the pool of each exiting thread
+static pthread_once_t tx_pool_once = PTHREAD_ONCE_INIT;
+
+/** Free the descriptors of the pool of the exiting thread.
+ * @param value Key value (unused)
+**/
+static void tx_pool_destroy(void* value as(unused)) {
+    while (tx_pool) {
+        struct transaction* next = tx_pool->next_free;
+#if defined(USE_STRIPED_LOCK)
+        free(tx_pool->held.data);
+        free(tx_pool->undo.data);
+        free(tx_pool->olds.data);
+        free(tx_pool->allocs.data);
+        free(tx_pool->frees.data);
+#endif
+        free(tx_pool);
+        tx_pool = next;
+    }
+}
+
+/** Create the key freeing the pools of the exiting threads.
+**/
+static void tx_pool_key_create() {
+    if (unlikely(pthread_key_create(&tx_pool_key, tx_pool_destroy) != 0)) // Only leaks the pools at thread exit
+        return;
+}
+
+/** Take a descriptor from the pool of the calling thread, allocating one if empty.
+ * @return Descriptor, 'NULL' on allocation failure
+**/
+static struct transaction* tx_acquire() {
+    struct transaction* tx = tx_pool;
+    if (likely(tx)) {
+        tx_pool = tx->next_free;
+        return tx;
+    }
+    pthread_once(&tx_pool_once, tx_pool_key_create);
+    pthread_setspecific(tx_pool_key, &tx_pool); // Any non-null value, for the destructor to run
+    if (unlikely(posix_memalign((void**) &tx, _Alignof(struct transaction), sizeof(struct transaction)) != 0))
+        return NULL;
+    memset(tx, 0, sizeof(struct transaction));
+    return tx;
+}
+
+/** Return a descriptor to the pool of the calling thread.
+ * @param tx Descriptor of the terminated transaction
+**/
+static void tx_recycle(struct transaction* tx) {
+    tx->next_free = tx_pool;
+    tx_pool = tx;
+}
+
+// -------------------------------------------------------------------------- //
+
+/** Header placed before every allocated segment.
+**/
+struct segment {
+    struct link link; // Link in the chain of allocated segments
+#if defined(USE_SEQLOCK_READS)
+    size_t size;      // Size of the user data (in bytes), to recycle the segment
+#endif
+};
 
 struct region {
     struct lock_t lock; // Global lock
@@ -357,6 +984,13 @@ struct region {
     size_t align;       // Claimed alignment of the shared memory region (in bytes)
     size_t align_alloc; // Actual alignment of the memory allocations (in bytes)
     size_t delta_alloc; // Space to add at the beginning of the segment for the link chain (in bytes)
+#if defined(USE_SEQLOCK_READS)
+    atomic_ulong seq;     // Sequence number, odd while a read-write transaction modifies the shared memory
+    struct link recycled; // Freed segments, never returned to the system since optimistic readers may still read them
+#endif
+#if defined(USE_STRIPED_LOCK)
+    struct stripe stripes[NB_STRIPES]; // Address-striped locks (the global lock then only guards 'allocs')
+#endif
 };
 
 shared_t tm_create(size_t size, size_t align) {
@@ -376,10 +1010,18 @@ shared_t tm_create(size_t size, size_t align) {
     }
     memset(region->start, 0, size);
     link_ref_reset(&(region->allocs));
+#if defined(USE_SEQLOCK_READS)
+    atomic_init(&(region->seq), 0ul);
+    link_ref_reset(&(region->recycled));
+#endif
+#if defined(USE_STRIPED_LOCK)
+    for (size_t i = 0; i < NB_STRIPES; ++i)
+        atomic_init(&(region->stripes[i].state), 0l);
+#endif
     region->size        = size;
     region->align       = align;
     region->align_alloc = align_alloc;
-    region->delta_alloc = (sizeof(struct link) + align_alloc - 1) / align_alloc * align_alloc;
+    region->delta_alloc = (sizeof(struct segment) + align_alloc - 1) / align_alloc * align_alloc;
     return region;
 }
 
@@ -393,9 +1035,19 @@ void tm_destroy(shared_t shared) {
         link_ref_remove(alloc);
         free(alloc);
     }
+#if defined(USE_SEQLOCK_READS)
+    struct link* recycled = &(region->recycled);
+    while (true) { // Free recycled segments
+        struct link* alloc = recycled->next;
+        if (alloc == recycled)
+            break;
+        link_ref_remove(alloc);
+        free(alloc);
+    }
+#endif
+    lock_cleanup(&(region->lock));
     free(region->start);
     free(region);
-    lock_cleanup(&(region->lock));
 }
 
 void* tm_start(shared_t shared) {
@@ -410,24 +1062,325 @@ size_t tm_align(shared_t shared) {
     return ((struct region*) shared)->align;
 }
 
+#if defined(USE_STRIPED_LOCK)
+
+/** Release every stripe held by the given transaction, then return its descriptor to the pool.
+ * @param region Shared memory region
+ * @param tx     Transaction to terminate
+**/
+static void tx_release(struct region* region, struct transaction* tx) {
+    array_foreach(&(tx->held), size_t, index) {
+        stripe_release(&(region->stripes[*index]), tx->modes[*index] == stripe_shared);
+        tx->modes[*index] = stripe_none;
+    }
+    tx->next_stripe = 0;
+    tx->held.size   = 0;
+    tx->undo.size   = 0;
+    tx->olds.size   = 0;
+    tx->allocs.size = 0;
+    tx->frees.size  = 0;
+    tx_recycle(tx);
+}
+
+/** Roll the given transaction back, then terminate it.
+ * @param region Shared memory region
+ * @param tx     Transaction to abort
+**/
+static void tx_abort(struct region* region, struct transaction* tx) {
+    struct undo* first = (struct undo*) tx->undo.data;
+    for (struct undo* undo = first + tx->undo.size / sizeof(struct undo); undo-- > first;) // Most recent first
+        memcpy(undo->target, (void*) ((uintptr_t) tx->olds.data + undo->offset), undo->size);
+    if (tx->allocs.size > 0) {
+        lock_acquire(&(region->lock), &(tx->node));
+        array_foreach(&(tx->allocs), struct link*, alloc) {
+            link_ref_remove(*alloc);
+            free(*alloc);
+        }
+        lock_release(&(region->lock), &(tx->node));
+    }
+    tx_release(region, tx);
+    sched_yield(); // Let the conflicting holder, possibly descheduled, commit before the retry
+}
+
+/** Acquire the stripes covering the given range, waiting only for stripes past all the ones already held.
+ * @param region    Shared memory region
+ * @param tx        Transaction acquiring the stripes
+ * @param addr      Start address in shared memory
+ * @param size      Range (in bytes)
+ * @param exclusive Whether to acquire the stripes in exclusive mode
+ * @return Whether the stripes are held, the transaction must abort otherwise
+**/
+static bool tx_lock(struct region* region, struct transaction* tx, void const* addr, size_t size, bool exclusive) {
+    size_t first = (uintptr_t) addr / STRIPE_GRAIN;
+    size_t last  = ((uintptr_t) addr + size - 1) / STRIPE_GRAIN;
+    for (size_t grain = first; grain <= last; ++grain) {
+        size_t index = stripe_of((void const*) (grain * STRIPE_GRAIN));
+        struct stripe* stripe = &(region->stripes[index]);
+        if (tx->modes[index] != stripe_none) // Read-write transactions only hold stripes exclusively, so no upgrade
+            continue;
+        bool block = index >= tx->next_stripe; // Out-of-order waits could deadlock, so only try those
+        if (unlikely(!(exclusive ? stripe_acquire(stripe, block) : stripe_acquire_shared(stripe, block))))
+            return false;
+        if (unlikely(!array_push(&(tx->held), size_t, index))) {
+            stripe_release(stripe, !exclusive);
+            return false;
+        }
+        tx->modes[index] = exclusive ? stripe_exclusive : stripe_shared;
+        if (index >= tx->next_stripe)
+            tx->next_stripe = index + 1;
+    }
+    return true;
+}
+
+tx_t tm_begin(shared_t shared as(unused), bool is_ro) {
+    struct transaction* tx = tx_acquire();
+    if (unlikely(!tx))
+        return invalid_tx;
+    tx->is_ro = is_ro;
+    return (tx_t) tx;
+}
+
+bool tm_end(shared_t shared, tx_t tx) {
+    struct region* region = (struct region*) shared;
+    struct transaction* transaction = (struct transaction*) tx;
+    if (transaction->frees.size > 0) { // Nobody else can reach the freed segments while the stripes are held
+        lock_acquire(&(region->lock), &(transaction->node));
+        array_foreach(&(transaction->frees), struct link*, segment) {
+            link_ref_remove(*segment);
+            free(*segment);
+        }
+        lock_release(&(region->lock), &(transaction->node));
+    }
+    tx_release(region, transaction);
+    return true;
+}
+
+bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* transaction = (struct transaction*) tx;
+    if (unlikely(!tx_lock(region, transaction, source, size, !transaction->is_ro))) { // Writers lock exclusively from the first access, as two readers could never both upgrade
+        tx_abort(region, transaction);
+        return false;
+    }
+    memcpy(target, source, size);
+    return true;
+}
+
+bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* transaction = (struct transaction*) tx;
+    if (unlikely(!tx_lock(region, transaction, target, size, true)))
+        goto abort;
+    { // Save the previous content, then write in place
+        struct undo undo = { .target = target, .size = size, .offset = transaction->olds.size };
+        void* old = array_append(&(transaction->olds), size);
+        if (unlikely(!old || !array_push(&(transaction->undo), struct undo, undo)))
+            goto abort;
+        memcpy(old, target, size);
+    }
+    memcpy(target, source, size);
+    return true;
+abort:
+    tx_abort(region, transaction);
+    return false;
+}
+
+alloc_t tm_alloc(shared_t shared, tx_t tx, size_t size, void** target) {
+    struct region* region = (struct region*) shared;
+    struct transaction* transaction = (struct transaction*) tx;
+    void* segment;
+    if (unlikely(posix_memalign(&segment, region->align_alloc, region->delta_alloc + size) != 0)) // Allocation failed
+        return nomem_alloc;
+    if (unlikely(!array_push(&(transaction->allocs), struct link*, (struct link*) segment))) {
+        free(segment);
+        return nomem_alloc;
+    }
+    lock_acquire(&(region->lock), &(transaction->node));
+    link_ref_insert((struct link*) segment, &(region->allocs));
+    lock_release(&(region->lock), &(transaction->node));
+    segment = (void*) ((uintptr_t) segment + region->delta_alloc);
+    memset(segment, 0, size);
+    *target = segment;
+    return success_alloc;
+}
+
+bool tm_free(shared_t shared, tx_t tx, void* segment) {
+    struct region* region = (struct region*) shared;
+    struct transaction* transaction = (struct transaction*) tx;
+    segment = (void*) ((uintptr_t) segment - region->delta_alloc);
+    if (unlikely(!array_push(&(transaction->frees), struct link*, (struct link*) segment))) {
+        tx_abort(region, transaction);
+        return false;
+    }
+    return true;
+}
+
+#else
+
+#if defined(USE_SEQLOCK_READS)
+
+#define SEQ_MAX_FAILURES 16 // Consecutive failed optimistic read-only transactions before taking the shared lock
+
+static _Thread_local unsigned int seq_failures = 0; // Consecutive failed optimistic read-only transactions of this thread
+
+/** Make the sequence number odd before the first in-place modification of the running read-write transaction.
+ * @param region Shared memory region, exclusively locked by the caller
+**/
+static void seq_write_begin(struct region* region) {
+    unsigned long seq = atomic_load_explicit(&(region->seq), memory_order_relaxed);
+    if (!(seq & 1)) {
+        atomic_store_explicit(&(region->seq), seq + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release); // Order the odd sequence number before the modifications
+    }
+}
+
+/** Make the sequence number even again if the terminating read-write transaction modified the shared memory.
+ * @param region Shared memory region, exclusively locked by the caller
+**/
+static void seq_write_end(struct region* region) {
+    unsigned long seq = atomic_load_explicit(&(region->seq), memory_order_relaxed);
+    if (seq & 1)
+        atomic_store_explicit(&(region->seq), seq + 1, memory_order_release);
+}
+
+/** Check that no read-write transaction modified the shared memory since the given optimistic transaction began.
+ * @param region Shared memory region
+ * @param seq    Sequence number the optimistic read-only transaction started at
+ * @return Whether the reads so far are consistent
+**/
+static bool seq_validate(struct region* region, unsigned long seq) {
+    atomic_thread_fence(memory_order_acquire); // Order the reads before the validation
+    if (likely(atomic_load_explicit(&(region->seq), memory_order_relaxed) == seq)) {
+        seq_failures = 0;
+        return true;
+    }
+    ++seq_failures;
+    return false;
+}
+
+tx_t tm_begin(shared_t shared, bool is_ro) {
+    struct region* region = (struct region*) shared;
+    struct transaction* tx = tx_acquire();
+    if (unlikely(!tx))
+        return invalid_tx;
+    tx->is_ro  = is_ro;
+    tx->locked = true;
+    if (is_ro) {
+        if (unlikely(seq_failures >= SEQ_MAX_FAILURES)) { // Starved by writers, fall back to the shared lock
+            if (unlikely(!lock_acquire_shared(&(region->lock), &(tx->node))))
+                goto fail;
+            return (tx_t) tx;
+        }
+        unsigned long seq; // Start once no read-write transaction is modifying the shared memory
+        while (unlikely((seq = atomic_load_explicit(&(region->seq), memory_order_acquire)) & 1))
+            pause();
+        tx->locked = false;
+        tx->seq    = seq;
+        return (tx_t) tx;
+    } else {
+        if (unlikely(!lock_acquire(&(region->lock), &(tx->node))))
+            goto fail;
+        return (tx_t) tx;
+    }
+fail:
+    tx_recycle(tx);
+    return invalid_tx;
+}
+
+bool tm_end(shared_t shared, tx_t tx) {
+    struct region* region = (struct region*) shared;
+    struct transaction* transaction = (struct transaction*) tx;
+    bool res = true;
+    if (!transaction->locked) {
+        res = seq_validate(region, transaction->seq);
+    } else if (transaction->is_ro) {
+        seq_failures = 0;
+        lock_release_shared(&(region->lock), &(transaction->node));
+    } else {
+        seq_write_end(region);
+        lock_release(&(region->lock), &(transaction->node));
+    }
+    tx_recycle(transaction);
+    return res;
+}
+
+bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* target) {
+    struct transaction* transaction = (struct transaction*) tx;
+    memcpy(target, source, size); // May race with a writer, hence the validation
+    if (!transaction->locked && unlikely(!seq_validate((struct region*) shared, transaction->seq))) {
+        tx_recycle(transaction); // Aborted, so never ended
+        return false;
+    }
+    return true;
+}
+
+bool tm_write(shared_t shared, tx_t tx as(unused), void const* source, size_t size, void* target) {
+    seq_write_begin((struct region*) shared);
+    memcpy(target, source, size);
+    return true;
+}
+
+alloc_t tm_alloc(shared_t shared, tx_t tx as(unused), size_t size, void** target) {
+    struct region* region = (struct region*) shared;
+    struct link* recycled = &(region->recycled);
+    struct segment* segment = NULL;
+    for (struct link* link = recycled->next; link != recycled; link = link->next) { // First fit among the recycled segments
+        if (objectof(link, struct segment, link)->size >= size) {
+            segment = objectof(link, struct segment, link);
+            link_ref_remove(link);
+            seq_write_begin(region); // Optimistic readers may still be reading the recycled segment
+            break;
+        }
+    }
+    if (!segment) {
+        if (unlikely(posix_memalign((void**) &segment, region->align_alloc, region->delta_alloc + size) != 0)) // Allocation failed
+            return nomem_alloc;
+        segment->size = size;
+    }
+    link_ref_insert(&(segment->link), &(region->allocs));
+    void* data = (void*) ((uintptr_t) segment + region->delta_alloc);
+    memset(data, 0, size);
+    *target = data;
+    return success_alloc;
+}
+
+bool tm_free(shared_t shared, tx_t tx as(unused), void* data) {
+    struct region* region = (struct region*) shared;
+    struct segment* segment = (struct segment*) ((uintptr_t) data - region->delta_alloc);
+    seq_write_begin(region);
+    link_ref_remove(&(segment->link));
+    link_ref_insert(&(segment->link), &(region->recycled));
+    return true;
+}
+
+#else
+
 tx_t tm_begin(shared_t shared, bool is_ro) {
+    struct transaction* tx = tx_acquire();
+    if (unlikely(!tx))
+        return invalid_tx;
+    tx->is_ro = is_ro;
     if (is_ro) {
-        if (unlikely(!lock_acquire_shared(&(((struct region*) shared)->lock))))
-            return invalid_tx;
-        return read_only_ref_tx;
+        if (unlikely(!lock_acquire_shared(&(((struct region*) shared)->lock), &(tx->node))))
+            goto fail;
     } else {
-        if (unlikely(!lock_acquire(&(((struct region*) shared)->lock))))
-            return invalid_tx;
-        return read_write_tx;
+        if (unlikely(!lock_acquire(&(((struct region*) shared)->lock), &(tx->node))))
+            goto fail;
     }
+    return (tx_t) tx;
+fail:
+    tx_recycle(tx);
+    return invalid_tx;
 }
 
 bool tm_end(shared_t shared, tx_t tx) {
-    if (tx == read_only_ref_tx) {
-        lock_release_shared(&(((struct region*) shared)->lock));
+    struct transaction* transaction = (struct transaction*) tx;
+    if (transaction->is_ro) {
+        lock_release_shared(&(((struct region*) shared)->lock), &(transaction->node));
     } else {
-        lock_release(&(((struct region*) shared)->lock));
+        lock_release(&(((struct region*) shared)->lock), &(transaction->node));
     }
+    tx_recycle(transaction);
     return true;
 }
 
@@ -461,3 +1414,7 @@ bool tm_free(shared_t shared, tx_t tx as(unused), void* segment) {
     free(segment);
     return true;
 }
+
+#endif
+
+#endif
@@ -0,0 +1,5 @@
+#!/bin/zsh
+set -e
+
+cd ..
+fd ".*\.(c|h)" include tl2 | xargs -I % sh -c "echo formatting %; clang-format -i %"
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "log.h"
+
+#define VEC_INIT_CAP 16
+#define WLOG_INIT_CAP 16
+
+bool vec_push(vec_t *vec, uintptr_t item) {
+  if (unlikely(vec->count == vec->cap)) {
+    size_t cap = vec->cap == 0 ? VEC_INIT_CAP : vec->cap * 2;
+    uintptr_t *items = realloc(vec->items, cap * sizeof(uintptr_t));
+    if (unlikely(!items))
+      return false;
+    vec->items = items;
+    vec->cap = cap;
+  }
+  vec->items[vec->count++] = item;
+  return true;
+}
+
+void vec_clear(vec_t *vec) { vec->count = 0; }
+
+void vec_destroy(vec_t *vec) {
+  free(vec->items);
+  vec->items = NULL;
+  vec->count = 0;
+  vec->cap = 0;
+}
+
+void wlog_init(wlog_t *log, size_t align) {
+  memset(log, 0, sizeof(wlog_t));
+  log->align = align;
+}
+
+static inline size_t wlog_hash(uintptr_t addr, size_t mask) {
+  return (size_t)((addr >> 3) * 0x9E3779B97F4A7C15ull) & mask;
+}
+
+static bool wlog_rehash(wlog_t *log, size_t table_cap) {
+  size_t *table = calloc(table_cap, sizeof(size_t));
+  if (unlikely(!table))
+    return false;
+  size_t mask = table_cap - 1;
+  for (size_t i = 0; i < log->count; i++) {
+    size_t slot = wlog_hash(log->entries[i].addr, mask);
+    while (table[slot] != 0)
+      slot = (slot + 1) & mask;
+    table[slot] = i + 1;
+    log->entries[i].slot = slot;
+  }
+  free(log->table);
+  log->table = table;
+  log->table_cap = table_cap;
+  return true;
+}
+
+void *wlog_lookup(wlog_t *log, uintptr_t addr) {
+  if (log->count == 0)
+    return NULL;
+  size_t mask = log->table_cap - 1;
+  size_t slot = wlog_hash(addr, mask);
+  while (log->table[slot] != 0) {
+    size_t index = log->table[slot] - 1;
+    if (log->entries[index].addr == addr)
+      return wlog_value(log, index);
+    slot = (slot + 1) & mask;
+  }
+  return NULL;
+}
+
+void *wlog_insert(wlog_t *log, uintptr_t addr) {
+  void *value = wlog_lookup(log, addr);
+  if (value)
+    return value;
+
+  if (unlikely(log->count == log->cap)) {
+    size_t cap = log->cap == 0 ? WLOG_INIT_CAP : log->cap * 2;
+    wentry_t *entries = realloc(log->entries, cap * sizeof(wentry_t));
+    if (unlikely(!entries))
+      return NULL;
+    log->entries = entries;
+    uint8_t *data = realloc(log->data, cap * log->align);
+    if (unlikely(!data))
+      return NULL;
+    log->data = data;
+    log->cap = cap;
+  }
+  // Keep the lookup table at most half full
+  if (unlikely((log->count + 1) * 2 > log->table_cap)) {
+    size_t table_cap = log->table_cap == 0 ? WLOG_INIT_CAP * 2 : log->table_cap * 2;
+    if (unlikely(!wlog_rehash(log, table_cap)))
+      return NULL;
+  }
+
+  size_t mask = log->table_cap - 1;
+  size_t slot = wlog_hash(addr, mask);
+  while (log->table[slot] != 0)
+    slot = (slot + 1) & mask;
+
+  size_t index = log->count++;
+  log->table[slot] = index + 1;
+  log->entries[index].addr = addr;
+  log->entries[index].slot = slot;
+  return wlog_value(log, index);
+}
+
+void wlog_clear(wlog_t *log) {
+  // Only touch the slots in use, the table keeps its grown capacity
+  for (size_t i = 0; i < log->count; i++)
+    log->table[log->entries[i].slot] = 0;
+  log->count = 0;
+}
+
+void wlog_destroy(wlog_t *log) {
+  free(log->entries);
+  free(log->table);
+  free(log->data);
+  memset(log, 0, sizeof(wlog_t));
+}
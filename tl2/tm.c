@@ -0,0 +1,402 @@
+#define _GNU_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#ifdef __STDC_NO_ATOMICS__
+#error Current C11 compiler does not support atomic operations
+#endif
+
+#include <assert.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "log.h"
+#include "tm.h"
+
+/* Transaction descriptors are pooled per thread and reused across
+ * transactions, so that the logs keep their grown capacity */
+static pthread_key_t pool_key;
+static pthread_once_t pool_key_once = PTHREAD_ONCE_INIT;
+
+static void pool_destroy(void *p) {
+  tx_desc_t *tx = (tx_desc_t *)p;
+  while (tx) {
+    tx_desc_t *next = tx->next_free;
+    vec_destroy(&tx->reads);
+    wlog_destroy(&tx->writes);
+    vec_destroy(&tx->locked);
+    vec_destroy(&tx->allocs);
+    vec_destroy(&tx->frees);
+    free(tx);
+    tx = next;
+  }
+}
+
+static void pool_key_create(void) {
+  assert(pthread_key_create(&pool_key, pool_destroy) == 0);
+}
+
+static tx_desc_t *desc_acquire(void) {
+  pthread_once(&pool_key_once, pool_key_create);
+  tx_desc_t *tx = (tx_desc_t *)pthread_getspecific(pool_key);
+  if (likely(tx)) {
+    pthread_setspecific(pool_key, tx->next_free);
+    return tx;
+  }
+  return (tx_desc_t *)calloc(1, sizeof(tx_desc_t));
+}
+
+static void desc_release(tx_desc_t *tx) {
+  tx->next_free = (tx_desc_t *)pthread_getspecific(pool_key);
+  if (unlikely(pthread_setspecific(pool_key, tx) != 0)) {
+    tx->next_free = NULL;
+    pool_destroy(tx);
+  }
+}
+
+static inline vlock_t *get_lock(region_t *region, void const *addr) {
+  return &region->locks[((uintptr_t)addr >> region->shift) &
+                        region->lock_mask];
+}
+
+static inline uintptr_t owner_of(tx_desc_t *tx) { return (uintptr_t)tx | 1; }
+
+/* Segments */
+
+static inline seg_t *seg_of(region_t *region, void *data) {
+  return (seg_t *)((uintptr_t)data - region->delta_alloc);
+}
+
+static inline void *data_of(region_t *region, seg_t *seg) {
+  return (void *)((uintptr_t)seg + region->delta_alloc);
+}
+
+static seg_t *alloc_seg(region_t *region, size_t size) {
+  int size_class = pow2_exp(region->delta_alloc + size);
+  seg_t *seg = NULL;
+
+  assert(pthread_mutex_lock(&region->seg_lock) == 0);
+  seg = region->free_segs[size_class];
+  if (seg)
+    region->free_segs[size_class] = seg->next_free;
+  assert(pthread_mutex_unlock(&region->seg_lock) == 0);
+
+  if (!seg) {
+    size_t alloc = pow2(size_class);
+    if (unlikely(posix_memalign((void **)&seg, region->align_alloc, alloc) !=
+                 0))
+      return NULL;
+    seg->size_class = size_class;
+    assert(pthread_mutex_lock(&region->seg_lock) == 0);
+    seg->next_all = region->segs;
+    region->segs = seg;
+    assert(pthread_mutex_unlock(&region->seg_lock) == 0);
+  }
+
+  seg->next_free = NULL;
+  seg->size = size;
+  memset(data_of(region, seg), 0, size);
+  return seg;
+}
+
+static void recycle_seg(region_t *region, seg_t *seg) {
+  assert(pthread_mutex_lock(&region->seg_lock) == 0);
+  seg->next_free = region->free_segs[seg->size_class];
+  region->free_segs[seg->size_class] = seg;
+  assert(pthread_mutex_unlock(&region->seg_lock) == 0);
+}
+
+/* Transaction life cycle */
+
+static void tx_finish(tx_desc_t *tx) {
+  vec_clear(&tx->reads);
+  wlog_clear(&tx->writes);
+  vec_clear(&tx->locked);
+  vec_clear(&tx->allocs);
+  vec_clear(&tx->frees);
+  desc_release(tx);
+}
+
+static void release_locks(tx_desc_t *tx, bool committed, uintptr_t wv) {
+  for (size_t i = 0; i < tx->locked.count; i += 2) {
+    vlock_t *lock = (vlock_t *)tx->locked.items[i];
+    uintptr_t version = committed ? wv : tx->locked.items[i + 1];
+    atomic_store_explicit(lock, version, memory_order_release);
+  }
+}
+
+static void tx_abort(tx_desc_t *tx) {
+  if (DEBUG1)
+    printf("[%p] TX abort\n", (void *)tx);
+  release_locks(tx, false, 0);
+  for (size_t i = 0; i < tx->allocs.count; i++)
+    recycle_seg(tx->region, (seg_t *)tx->allocs.items[i]);
+  tx_finish(tx);
+}
+
+static bool acquire_lock(tx_desc_t *tx, vlock_t *lock) {
+  uintptr_t owner = owner_of(tx);
+  for (int spins = 0; spins < LOCK_SPINS; spins++) {
+    uintptr_t cur = atomic_load_explicit(lock, memory_order_relaxed);
+    if (cur == owner)
+      return true;
+    if (!(cur & 1)) {
+      if (atomic_compare_exchange_weak_explicit(lock, &cur, owner,
+                                                memory_order_acquire,
+                                                memory_order_relaxed)) {
+        if (unlikely(!vec_push(&tx->locked, (uintptr_t)lock) ||
+                     !vec_push(&tx->locked, cur))) {
+          atomic_store_explicit(lock, cur, memory_order_release);
+          return false;
+        }
+        return true;
+      }
+      continue;
+    }
+    sched_yield();
+  }
+  // Locks are taken in no particular order, give up instead of deadlocking
+  return false;
+}
+
+static uintptr_t locked_version(tx_desc_t *tx, vlock_t *lock) {
+  for (size_t i = 0; i < tx->locked.count; i += 2)
+    if ((vlock_t *)tx->locked.items[i] == lock)
+      return tx->locked.items[i + 1];
+  return UINTPTR_MAX;
+}
+
+static bool validate_reads(tx_desc_t *tx) {
+  uintptr_t owner = owner_of(tx);
+  for (size_t i = 0; i < tx->reads.count; i++) {
+    vlock_t *lock = (vlock_t *)tx->reads.items[i];
+    uintptr_t cur = atomic_load_explicit(lock, memory_order_acquire);
+    if (cur == owner)
+      cur = locked_version(tx, lock);
+    if ((cur & 1) || cur > tx->rv)
+      return false;
+  }
+  return true;
+}
+
+static bool tx_commit(tx_desc_t *tx) {
+  region_t *region = tx->region;
+
+  if (tx->writes.count == 0 && tx->frees.count == 0) {
+    // Every read was consistent with 'rv' when it happened
+    tx_finish(tx);
+    return true;
+  }
+
+  // Lock the redo log, then every word of the freed segments so that stale
+  // readers of recycled memory observe a newer version
+  for (size_t i = 0; i < tx->writes.count; i++) {
+    if (unlikely(!acquire_lock(
+            tx, get_lock(region, (void *)tx->writes.entries[i].addr))))
+      goto abort;
+  }
+  for (size_t i = 0; i < tx->frees.count; i++) {
+    seg_t *seg = (seg_t *)tx->frees.items[i];
+    uint8_t *data = (uint8_t *)data_of(region, seg);
+    for (size_t offset = 0; offset < seg->size; offset += region->align) {
+      if (unlikely(!acquire_lock(tx, get_lock(region, data + offset))))
+        goto abort;
+    }
+  }
+
+  uintptr_t wv =
+      atomic_fetch_add_explicit(&region->clock, 2, memory_order_acq_rel) + 2;
+  if (wv != tx->rv + 2 && unlikely(!validate_reads(tx)))
+    goto abort;
+
+  for (size_t i = 0; i < tx->writes.count; i++)
+    memcpy((void *)tx->writes.entries[i].addr, wlog_value(&tx->writes, i),
+           region->align);
+  release_locks(tx, true, wv);
+  for (size_t i = 0; i < tx->frees.count; i++)
+    recycle_seg(region, (seg_t *)tx->frees.items[i]);
+  tx_finish(tx);
+  return true;
+
+abort:
+  tx_abort(tx);
+  return false;
+}
+
+/* Interface */
+
+shared_t tm_create(size_t size, size_t align) {
+  if (DEBUG1)
+    printf("TM create, size: %ld, align: %ld\n", size, align);
+  region_t *region = (region_t *)calloc(1, sizeof(region_t));
+  if (unlikely(!region))
+    return invalid_shared;
+
+  size_t nblocks = size / align * LOCK_TABLE_HEADROOM;
+  int bits = nblocks > 1 ? pow2_exp(nblocks) : 0;
+  if (bits < LOCK_TABLE_MIN_BITS)
+    bits = LOCK_TABLE_MIN_BITS;
+  if (bits > LOCK_TABLE_MAX_BITS)
+    bits = LOCK_TABLE_MAX_BITS;
+  region->lock_mask = pow2(bits) - 1;
+  region->locks = (vlock_t *)calloc(pow2(bits), sizeof(vlock_t));
+  if (unlikely(!region->locks)) {
+    free(region);
+    return invalid_shared;
+  }
+  assert(pthread_mutex_init(&region->seg_lock, NULL) == 0);
+  atomic_init(&region->clock, 0);
+
+  // Also satisfy the alignment requirement of 'seg_t'
+  size_t align_alloc = align < sizeof(void *) ? sizeof(void *) : align;
+  region->size = size;
+  region->align = align;
+  region->align_alloc = align_alloc;
+  region->delta_alloc =
+      (sizeof(seg_t) + align_alloc - 1) / align_alloc * align_alloc;
+  region->shift = __builtin_ctzl(align);
+
+  seg_t *seg = alloc_seg(region, size);
+  if (unlikely(!seg)) {
+    free(region->locks);
+    free(region);
+    return invalid_shared;
+  }
+  region->start = data_of(region, seg);
+  return region;
+}
+
+void tm_destroy(shared_t shared) {
+  if (DEBUG1)
+    printf("TM destroy\n");
+  region_t *region = (region_t *)shared;
+  seg_t *seg = region->segs;
+  while (seg) {
+    seg_t *next = seg->next_all;
+    free(seg);
+    seg = next;
+  }
+  pthread_mutex_destroy(&region->seg_lock);
+  free(region->locks);
+  free(region);
+}
+
+void *tm_start(shared_t shared) { return ((region_t *)shared)->start; }
+
+size_t tm_size(shared_t shared) { return ((region_t *)shared)->size; }
+
+size_t tm_align(shared_t shared) { return ((region_t *)shared)->align; }
+
+tx_t tm_begin(shared_t shared, bool is_ro) {
+  region_t *region = (region_t *)shared;
+  tx_desc_t *tx = desc_acquire();
+  if (unlikely(!tx))
+    return invalid_tx;
+
+  if (unlikely(tx->writes.align != region->align)) {
+    wlog_destroy(&tx->writes);
+    wlog_init(&tx->writes, region->align);
+  }
+  tx->region = region;
+  tx->is_ro = is_ro;
+  tx->rv = atomic_load_explicit(&region->clock, memory_order_acquire);
+
+  if (DEBUG1)
+    printf("[%p] TM begin, rv: %lu\n", (void *)tx, tx->rv);
+  return (tx_t)tx;
+}
+
+bool tm_end(shared_t shared as(unused), tx_t tx) {
+  if (DEBUG1)
+    printf("[%lx] TM end\n", tx);
+  return tx_commit((tx_desc_t *)tx);
+}
+
+/* Invisible read of one word: sample the lock before and after the copy, and
+ * give up if the word is being committed or changed after 'rv' */
+static inline bool read_word(tx_desc_t *tx, void const *source, void *target) {
+  region_t *region = tx->region;
+  vlock_t *lock = get_lock(region, source);
+
+  uintptr_t pre = atomic_load_explicit(lock, memory_order_acquire);
+  if ((pre & 1) || pre > tx->rv)
+    return false;
+  memcpy(target, source, region->align);
+  atomic_thread_fence(memory_order_acquire);
+  if (atomic_load_explicit(lock, memory_order_relaxed) != pre)
+    return false;
+
+  if (!tx->is_ro)
+    return vec_push(&tx->reads, (uintptr_t)lock);
+  return true;
+}
+
+bool tm_read(shared_t shared, tx_t tx_id, void const *source, size_t size,
+             void *target) {
+  region_t *region = (region_t *)shared;
+  tx_desc_t *tx = (tx_desc_t *)tx_id;
+  size_t align = region->align;
+
+  for (size_t offset = 0; offset < size; offset += align) {
+    uint8_t const *src = (uint8_t const *)source + offset;
+    uint8_t *dst = (uint8_t *)target + offset;
+
+    if (!tx->is_ro) {
+      void *value = wlog_lookup(&tx->writes, (uintptr_t)src);
+      if (value) {
+        memcpy(dst, value, align);
+        continue;
+      }
+    }
+    if (unlikely(!read_word(tx, src, dst))) {
+      tx_abort(tx);
+      return false;
+    }
+  }
+  return true;
+}
+
+bool tm_write(shared_t shared, tx_t tx_id, void const *source, size_t size,
+              void *target) {
+  region_t *region = (region_t *)shared;
+  tx_desc_t *tx = (tx_desc_t *)tx_id;
+  size_t align = region->align;
+
+  for (size_t offset = 0; offset < size; offset += align) {
+    void *value = wlog_insert(&tx->writes, (uintptr_t)target + offset);
+    if (unlikely(!value)) {
+      tx_abort(tx);
+      return false;
+    }
+    memcpy(value, (uint8_t const *)source + offset, align);
+  }
+  return true;
+}
+
+alloc_t tm_alloc(shared_t shared, tx_t tx_id, size_t size, void **target) {
+  region_t *region = (region_t *)shared;
+  tx_desc_t *tx = (tx_desc_t *)tx_id;
+
+  seg_t *seg = alloc_seg(region, size);
+  if (unlikely(!seg))
+    return nomem_alloc;
+  if (unlikely(!vec_push(&tx->allocs, (uintptr_t)seg))) {
+    recycle_seg(region, seg);
+    return nomem_alloc;
+  }
+  *target = data_of(region, seg);
+  return success_alloc;
+}
+
+bool tm_free(shared_t shared, tx_t tx_id, void *target) {
+  region_t *region = (region_t *)shared;
+  tx_desc_t *tx = (tx_desc_t *)tx_id;
+
+  if (unlikely(!vec_push(&tx->frees, (uintptr_t)seg_of(region, target)))) {
+    tx_abort(tx);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "log.h"
+
+/* Versioned write-locks, indexed by word address. An even value is the
+ * version of the last commit that wrote a word mapped to the lock, an odd
+ * value is the descriptor of the owning transaction with the low bit set.
+ * Each region sizes its table from the words of its first segment, with
+ * headroom for the segments allocated later, within the bounds below */
+#define LOCK_TABLE_MIN_BITS 12
+#define LOCK_TABLE_MAX_BITS 20
+#define LOCK_TABLE_HEADROOM 4 // Locks per word of the first segment
+#define LOCK_SPINS 64
+
+#define SIZE_CLASSES 64
+
+typedef atomic_uintptr_t vlock_t;
+
+typedef struct seg_s {
+  struct seg_s *next_all;  // Next segment ever allocated in the region
+  struct seg_s *next_free; // Next segment in the same free list
+  size_t size;             // Size of the user data (in bytes)
+  int size_class;          // Allocated bytes are 2^size_class
+} seg_t;
+
+typedef struct region_s {
+  atomic_uintptr_t clock; // Global version clock (always even)
+  vlock_t *locks;
+  size_t lock_mask; // Number of locks minus one (a power of two)
+  void *start;
+  size_t size;
+  size_t align;
+  size_t align_alloc;
+  size_t delta_alloc; // Room for 'seg_t' before the user data (in bytes)
+  int shift;          // log2 of 'align', to map words to locks
+  pthread_mutex_t seg_lock;
+  seg_t *segs;
+  // Freed segments are recycled but never returned to the system while the
+  // region lives, so that invisible readers never touch unmapped memory
+  seg_t *free_segs[SIZE_CLASSES];
+} region_t;
+
+typedef uintptr_t tx_t;
+static tx_t const invalid_tx = ~((tx_t)0);
+
+typedef struct tx_s {
+  struct tx_s *next_free; // Next descriptor in the thread's pool
+  region_t *region;
+  bool is_ro;
+  uintptr_t rv;  // Clock value sampled at begin
+  vec_t reads;   // Locks covering the words read (read-write only)
+  wlog_t writes; // Redo log
+  vec_t locked;  // Pairs of (lock, version before acquisition)
+  vec_t allocs;  // Segments allocated, recycled on abort
+  vec_t frees;   // Segments freed, recycled on commit
+} tx_desc_t;
+
+typedef void *shared_t;
+static shared_t const invalid_shared = NULL;
+
+typedef int alloc_t;
+static alloc_t const success_alloc = 0;
+static alloc_t const abort_alloc = 1;
+static alloc_t const nomem_alloc = 2;
+
+// Interface
+
+shared_t tm_create(size_t, size_t);
+void tm_destroy(shared_t);
+void *tm_start(shared_t);
+size_t tm_size(shared_t);
+size_t tm_align(shared_t);
+tx_t tm_begin(shared_t, bool);
+bool tm_end(shared_t, tx_t);
+bool tm_read(shared_t, tx_t, void const *, size_t, void *);
+bool tm_write(shared_t, tx_t, void const *, size_t, void *);
+alloc_t tm_alloc(shared_t, tx_t, size_t, void **);
+bool tm_free(shared_t, tx_t, void *);